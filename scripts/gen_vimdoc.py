@@ -35,7 +35,7 @@ Each function :help block is formatted as follows:
     - Subsection bodies are indented an additional 4 spaces.
   - Body consists of function description, parameters, return description, and
     C declaration (`INCLUDE_C_DECL`).
-  - Parameters are omitted for the `void` and `Error *` types, or if the
+  - Parameters are omitted for the `void`, `Error *` and `Arena *` types, or if the
     parameter is marked as [out].
   - Each function documentation is separated by a single line.
 """
@@ -268,6 +268,7 @@ param_exclude = (
 # Annotations are displayed as line items after API function descriptions.
 annotation_map = {
     'FUNC_API_FAST': '{fast}',
+    'FUNC_API_READONLY': '{readonly}',
     'FUNC_API_CHECK_TEXTLOCK': 'not allowed when |textlock| is active',
 }
 
@@ -793,7 +794,7 @@ def extract_from_xml(filename, target, width):
 
         prefix = '%s(' % name
         suffix = '%s)' % ', '.join('{%s}' % a[1] for a in params
-                                   if a[0] not in ('void', 'Error'))
+                                   if a[0] not in ('void', 'Error', 'Arena'))
 
         if not fmt_vimhelp:
             c_decl = '%s %s(%s);' % (return_type, name, ', '.join(c_args))
@@ -21,6 +21,8 @@
 #include "nvim/ex_cmds.h"
 #include "nvim/ex_docmd.h"
 #include "nvim/extmark.h"
+#include "nvim/garray.h"
+#include "nvim/lib/kvec.h"
 #include "nvim/lua/executor.h"
 #include "nvim/mark.h"
 #include "nvim/memline.h"
@@ -59,6 +61,7 @@
 /// @return Line count, or 0 for unloaded buffer. |api-buffer|
 Integer nvim_buf_line_count(Buffer buffer, Error *err)
   FUNC_API_SINCE(1)
+  FUNC_API_READONLY
 {
   buf_T *buf = find_buffer_by_handle(buffer, err);
 
@@ -271,8 +274,10 @@ ArrayOf(String) nvim_buf_get_lines(uint64_t channel_id,
                                    Integer start,
                                    Integer end,
                                    Boolean strict_indexing,
+                                   Arena *arena,
                                    Error *err)
   FUNC_API_SINCE(1)
+  FUNC_API_READONLY
 {
   Array rv = ARRAY_DICT_INIT;
   buf_T *buf = find_buffer_by_handle(buffer, err);
@@ -300,25 +305,140 @@ ArrayOf(String) nvim_buf_get_lines(uint64_t channel_id,
     return rv;
   }
 
-  rv.size = (size_t)(end - start);
-  rv.items = xcalloc(rv.size, sizeof(Object));
+  rv = arena_array(arena, (size_t)(end - start));
+  rv.size = rv.capacity;
 
   if (!buf_collect_lines(buf, rv.size, start,
-                         (channel_id != VIML_INTERNAL_CALL), &rv, err)) {
+                         (channel_id != VIML_INTERNAL_CALL), &rv, arena, err)) {
     goto end;
   }
 
 end:
   if (ERROR_SET(err)) {
-    for (size_t i = 0; i < rv.size; i++) {
-      xfree(rv.items[i].data.string.data);
+    // Lines from an arena are freed with it.
+    if (!arena) {
+      for (size_t i = 0; i < rv.size; i++) {
+        xfree(rv.items[i].data.string.data);
+      }
+      xfree(rv.items);
     }
+    rv = (Array)ARRAY_DICT_INIT;
+  }
+
+  return rv;
+}
+
+typedef struct {
+  int64_t start;  ///< First line number.
+  int64_t end;    ///< Line number after the last line.
+  size_t idx;     ///< Index of the range in the request.
+} TextRange;
+
+static int text_range_cmp(const void *a, const void *b)
+{
+  const TextRange *ra = a;
+  const TextRange *rb = b;
+  return ra->start == rb->start ? 0 : (ra->start < rb->start ? -1 : 1);
+}
 
-    xfree(rv.items);
-    rv.items = NULL;
+/// Gets the text of many line-ranges of many buffers at once.
+///
+/// Like |nvim_buf_get_lines()| for each range, but in one request, and each
+/// range is returned as one String: the lines, each followed by a newline.
+/// NULs in the text are returned as NUL, as newlines separate the lines. This
+/// saves building a list of lines per range, e.g. in Lua. The ranges of a
+/// buffer are read in order of their start, in one pass over the buffer.
+///
+/// Example: >
+///   nvim_get_text_batch([[buf1, [[0, 10], [20, -1]]], [buf2, [[0, -1]]]])
+/// <
+///
+/// @param requests  Array of `[buffer, ranges]` pairs, `ranges` is an Array of
+///                  `[start, end]` line indices like |nvim_buf_get_lines()|.
+///                  Out-of-bounds indices are clamped.
+/// @param[out] err  Error details, if any
+/// @return Array with an Array of Strings for each request, one String per
+///         range. The Array is empty for an unloaded buffer.
+ArrayOf(Array) nvim_get_text_batch(Array requests, Error *err)
+  FUNC_API_SINCE(9)
+  FUNC_API_READONLY
+{
+  Array rv = ARRAY_DICT_INIT;
+  kvec_t(TextRange) ranges = KV_INITIAL_VALUE;
+
+  for (size_t i = 0; i < requests.size; i++) {
+    Object req = requests.items[i];
+    if (req.type != kObjectTypeArray || req.data.array.size != 2
+        || req.data.array.items[1].type != kObjectTypeArray
+        || (req.data.array.items[0].type != kObjectTypeBuffer
+            && req.data.array.items[0].type != kObjectTypeInteger)) {
+      api_set_error(err, kErrorTypeValidation,
+                    "Request %zu must be an array of a buffer and ranges", i);
+      goto error;
+    }
+    buf_T *buf = find_buffer_by_handle((Buffer)req.data.array.items[0].data.integer, err);
+    if (!buf) {
+      goto error;
+    }
+    Array req_ranges = req.data.array.items[1].data.array;
+
+    kv_size(ranges) = 0;
+    for (size_t j = 0; j < req_ranges.size; j++) {
+      Object range = req_ranges.items[j];
+      if (range.type != kObjectTypeArray || range.data.array.size != 2
+          || range.data.array.items[0].type != kObjectTypeInteger
+          || range.data.array.items[1].type != kObjectTypeInteger) {
+        api_set_error(err, kErrorTypeValidation,
+                      "Range %zu of request %zu must be an array of two integers", j, i);
+        goto error;
+      }
+      if (buf->b_ml.ml_mfp == NULL) {
+        continue;
+      }
+      bool oob = false;
+      kv_push(ranges, ((TextRange) {
+        .start = normalize_index(buf, range.data.array.items[0].data.integer, &oob),
+        .end = normalize_index(buf, range.data.array.items[1].data.integer, &oob),
+        .idx = j,
+      }));
+    }
+
+    Array texts = ARRAY_DICT_INIT;
+    if (kv_size(ranges)) {
+      texts.size = texts.capacity = kv_size(ranges);
+      texts.items = xcalloc(texts.size, sizeof(Object));
+      qsort(ranges.items, kv_size(ranges), sizeof(TextRange), text_range_cmp);
+      for (size_t j = 0; j < kv_size(ranges); j++) {
+        TextRange range = kv_A(ranges, j);
+        garray_T ga;
+        ga_init(&ga, 1, 1024);
+        for (int64_t lnum = range.start; lnum < range.end; lnum++) {
+          char *line = (char *)ml_get_buf(buf, (linenr_T)lnum, false);
+          size_t len = strlen(line);
+          if (len) {
+            ga_concat_len(&ga, line, len);
+            // Vim represents NULs as NLs.
+            memchrsub((char *)ga.ga_data + ga.ga_len - len, NL, NUL, len);
+          }
+          ga_append(&ga, NL);
+        }
+        ga_append(&ga, NUL);
+        texts.items[range.idx] = STRING_OBJ(((String) {
+          .data = ga.ga_data,
+          .size = (size_t)ga.ga_len - 1,
+        }));
+      }
+    }
+    ADD(rv, ARRAY_OBJ(texts));
   }
 
+  kv_destroy(ranges);
   return rv;
+
+error:
+  kv_destroy(ranges);
+  api_free_array(rv);
+  return (Array)ARRAY_DICT_INIT;
 }
 
 static bool check_string_array(Array arr, bool disallow_nl, Error *err)
@@ -818,6 +938,7 @@ Object nvim_buf_get_var(Buffer buffer, String name, Error *err)
 /// @return `b:changedtick` value.
 Integer nvim_buf_get_changedtick(Buffer buffer, Error *err)
   FUNC_API_SINCE(2)
+  FUNC_API_READONLY
 {
   const buf_T *const buf = find_buffer_by_handle(buffer, err);
 
@@ -983,6 +1104,7 @@ void nvim_buf_set_option(uint64_t channel_id, Buffer buffer, String name, Object
 /// @return Buffer name
 String nvim_buf_get_name(Buffer buffer, Error *err)
   FUNC_API_SINCE(1)
+  FUNC_API_READONLY
 {
   String rv = STRING_INIT;
   buf_T *buf = find_buffer_by_handle(buffer, err);
@@ -1032,6 +1154,7 @@ void nvim_buf_set_name(Buffer buffer, String name, Error *err)
 /// @return true if the buffer is valid and loaded, false otherwise.
 Boolean nvim_buf_is_loaded(Buffer buffer)
   FUNC_API_SINCE(5)
+  FUNC_API_READONLY
 {
   Error stub = ERROR_INIT;
   buf_T *buf = find_buffer_by_handle(buffer, &stub);
@@ -1095,6 +1218,7 @@ void nvim_buf_delete(Buffer buffer, Dictionary opts, Error *err)
 /// @return true if the buffer is valid, false otherwise.
 Boolean nvim_buf_is_valid(Buffer buffer)
   FUNC_API_SINCE(1)
+  FUNC_API_READONLY
 {
   Error stub = ERROR_INIT;
   Boolean ret = find_buffer_by_handle(buffer, &stub) != NULL;
@@ -2,19 +2,27 @@
 #define NVIM_API_PRIVATE_DISPATCH_H
 
 #include "nvim/api/private/defs.h"
+#include "nvim/memory.h"
 
 typedef Object (*ApiDispatchWrapper)(uint64_t channel_id,
                                      Array args,
+                                     Arena *arena,
                                      Error *error);
 
 /// The rpc_method_handlers table, used in msgpack_rpc_dispatch(), stores
 /// functions of this type.
 typedef struct {
   ApiDispatchWrapper fn;
+  const char *name;
+  uint32_t id;  // Index of the method, see RpcStats.
   bool fast;  // Function is safe to be executed immediately while running the
               // uv loop (the loop is run very frequently due to breakcheck).
               // If "fast" is false, the function is deferred, i e the call will
               // be put in the event queue, for safe handling later.
+  bool readonly;  // Function only reads editor state. When the main loop is
+                  // idle, it is invoked immediately instead of being deferred.
+  bool arena_return;  // return value is allocated in the arena (or statically)
+                      // and should not be freed as such.
 } MsgpackRpcRequestHandler;
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
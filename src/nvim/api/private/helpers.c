@@ -516,6 +516,27 @@ String cstrn_to_string(const char *str, size_t maxsize)
   return cbuf_to_string(str, STRNLEN(str, maxsize));
 }
 
+/// Copies `str` into `arena`, see arena_alloc().
+String arena_string(Arena *arena, String str)
+{
+  if (!str.data) {
+    return (String)STRING_INIT;
+  }
+  return (String){ .data = arena_memdupz(arena, str.data, str.size), .size = str.size };
+}
+
+/// Creates an Array with room for `max_size` items in `arena`, see
+/// arena_alloc(). Add items with ADD_C().
+Array arena_array(Arena *arena, size_t max_size)
+{
+  Array arr = ARRAY_DICT_INIT;
+  if (max_size) {
+    arr.items = arena_alloc(arena, max_size * sizeof(Object), true);
+    arr.capacity = max_size;
+  }
+  return arr;
+}
+
 /// Creates a String using the given C string. Unlike
 /// cstr_to_string this function DOES NOT copy the C string.
 ///
@@ -730,9 +751,11 @@ fail_and_free:
 /// @param replace_nl Replace newlines ("\n") with NUL
 /// @param start Line number to start from
 /// @param[out] l Lines are copied here
+/// @param arena Arena for the lines, or NULL, see arena_alloc()
 /// @param err[out] Error, if any
 /// @return true unless `err` was set
-bool buf_collect_lines(buf_T *buf, size_t n, int64_t start, bool replace_nl, Array *l, Error *err)
+bool buf_collect_lines(buf_T *buf, size_t n, int64_t start, bool replace_nl, Array *l,
+                       Arena *arena, Error *err)
 {
   for (size_t i = 0; i < n; i++) {
     int64_t lnum = start + (int64_t)i;
@@ -741,11 +764,12 @@ bool buf_collect_lines(buf_T *buf, size_t n, int64_t start, bool replace_nl, Arr
       if (err != NULL) {
         api_set_error(err, kErrorTypeValidation, "Line index is too high");
       }
+      l->size = i;  // Only the collected lines need to be freed.
       return false;
     }
 
-    const char *bufstr = (char *)ml_get_buf(buf, (linenr_T)lnum, false);
-    Object str = STRING_OBJ(cstr_to_string(bufstr));
+    char *bufstr = (char *)ml_get_buf(buf, (linenr_T)lnum, false);
+    Object str = STRING_OBJ(arena_string(arena, cstr_as_string(bufstr)));
 
     if (replace_nl) {
       // Vim represents NULs as NLs, but this may confuse clients.
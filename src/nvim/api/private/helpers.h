@@ -68,6 +68,10 @@
 #define ADD(array, item) \
   kv_push(array, item)
 
+/// Adds an item to an Array with enough room, like one from arena_array().
+#define ADD_C(array, item) \
+  ((array).items[(array).size++] = (item))
+
 #define FIXED_TEMP_ARRAY(name, fixsize) \
   Array name = ARRAY_DICT_INIT; \
   Object name##__items[fixsize]; \
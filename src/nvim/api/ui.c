@@ -11,9 +11,11 @@
 #include "nvim/api/ui.h"
 #include "nvim/cursor_shape.h"
 #include "nvim/highlight.h"
+#include "nvim/lib/kvec.h"
 #include "nvim/map.h"
 #include "nvim/memory.h"
 #include "nvim/msgpack_rpc/channel.h"
+#include "nvim/msgpack_rpc/packer.h"
 #include "nvim/popupmnu.h"
 #include "nvim/screen.h"
 #include "nvim/ui.h"
@@ -27,7 +29,15 @@
 
 typedef struct {
   uint64_t channel_id;
-  Array buffer;
+
+  // Pending "redraw" notification, written as the events arrive, see
+  // prepare_call(). The counts are patched in when it is sent.
+  PackerBuffer buf;
+  size_t nevents_pos;  // Placeholder for the number of events.
+  uint32_t nevents;
+  size_t ncalls_pos;  // Placeholder for the size of the current event.
+  uint32_t ncalls;  // Calls of the current event, plus one for its name.
+  const char *cur_event;  // Name of the current event, a string literal.
 
   int hl_id;  // Current highlight for legacy put event.
   Integer cursor_row, cursor_col;  // Intended visible cursor position.
@@ -35,10 +45,25 @@ typedef struct {
   // Position of legacy cursor, used both for drawing and visible user cursor.
   Integer client_row, client_col;
   bool wildmenu_active;
+
+  // Backpressure, see remote_ui_flush().
+  size_t lag_limit;  // Unwritten bytes after which frames are dropped, 0: never.
+  size_t lag_max;  // Most unwritten bytes seen at a flush.
+  Integer frames;  // Flushed batches, including dropped ones.
+  Integer frames_dropped;
+  bool resync_pending;  // Batches were dropped, a full refresh is needed.
+  bool resync_scheduled;  // remote_ui_resync_event() is queued.
 } UIData;
 
+/// Default of the "lag_limit" |ui-option|.
+#define DEFAULT_LAG_LIMIT (4 * 1024 * 1024)
+
 static PMap(uint64_t) connected_uis = MAP_INIT;
 
+/// Glyph table index plus one of each glyph in the "grid_line_binary" event
+/// being built. Keys point into that event's glyph table.
+static Map(cstr_t, int) glyph_ids = MAP_INIT;
+
 void remote_ui_disconnect(uint64_t channel_id)
 {
   UI *ui = pmap_get(uint64_t)(&connected_uis, channel_id);
@@ -46,7 +71,7 @@ void remote_ui_disconnect(uint64_t channel_id)
     return;
   }
   UIData *data = ui->data;
-  api_free_array(data->buffer);  // Destroy pending screen updates.
+  packer_free(&data->buf);  // Destroy pending screen updates.
   pmap_del(uint64_t)(&connected_uis, channel_id);
   xfree(ui->data);
   ui->data = NULL;  // Flag UI as "stopped".
@@ -137,15 +162,25 @@ void nvim_ui_attach(uint64_t channel_id, Integer width, Integer height, Dictiona
 
   memset(ui->ui_ext, 0, sizeof(ui->ui_ext));
 
+  UIData *data = xcalloc(1, sizeof(UIData));
+  data->channel_id = channel_id;
+  data->buf = (PackerBuffer)PACKER_BUFFER_INIT;
+  data->hl_id = 0;
+  data->client_col = -1;
+  data->wildmenu_active = false;
+  data->lag_limit = DEFAULT_LAG_LIMIT;
+  ui->data = data;
+
   for (size_t i = 0; i < options.size; i++) {
     ui_set_option(ui, true, options.items[i].key, options.items[i].value, err);
     if (ERROR_SET(err)) {
+      xfree(data);
       xfree(ui);
       return;
     }
   }
 
-  if (ui->ui_ext[kUIHlState] || ui->ui_ext[kUIMultigrid]) {
+  if (ui->ui_ext[kUIHlState] || ui->ui_ext[kUIMultigrid] || ui->ui_ext[kUIGridBinary]) {
     ui->ui_ext[kUILinegrid] = true;
   }
 
@@ -156,14 +191,6 @@ void nvim_ui_attach(uint64_t channel_id, Integer width, Integer height, Dictiona
     ui->ui_ext[kUICmdline] = true;
   }
 
-  UIData *data = xmalloc(sizeof(UIData));
-  data->channel_id = channel_id;
-  data->buffer = (Array)ARRAY_DICT_INIT;
-  data->hl_id = 0;
-  data->client_col = -1;
-  data->wildmenu_active = false;
-  ui->data = data;
-
   pmap_put(uint64_t)(&connected_uis, channel_id, ui);
   ui_attach_impl(ui, channel_id);
 }
@@ -255,6 +282,16 @@ static void ui_set_option(UI *ui, bool init, String name, Object value, Error *e
     return;
   }
 
+  if (strequal(name.data, "lag_limit")) {
+    if (value.type != kObjectTypeInteger || value.data.integer < 0) {
+      api_set_error(error, kErrorTypeValidation,
+                    "lag_limit must be a non-negative Integer");
+      return;
+    }
+    ((UIData *)ui->data)->lag_limit = (size_t)value.data.integer;
+    return;
+  }
+
   // LEGACY: Deprecated option, use `ext_cmdline` instead.
   bool is_popupmenu = strequal(name.data, "popupmenu_external");
 
@@ -386,27 +423,50 @@ void nvim_ui_pum_set_bounds(uint64_t channel_id, Float width, Float height, Floa
   ui->pum_pos = true;
 }
 
-/// Pushes data into UI.UIData, to be consumed later by remote_ui_flush().
-static void push_call(UI *ui, const char *name, Array args)
+/// Starts a call to `name` in UI.UIData, to be sent later by
+/// remote_ui_flush(). The arguments are written by the caller, as one array.
+///
+/// @param name  Event name, must be a string literal.
+static PackerBuffer *prepare_call(UI *ui, const char *name)
 {
-  Array call = ARRAY_DICT_INIT;
   UIData *data = ui->data;
+  PackerBuffer *b = &data->buf;
+
+  if (!packer_size(b)) {
+    // [2, "redraw", [events...]]
+    packer_array(b, 3);
+    packer_integer(b, 2);
+    packer_str(b, S_LEN("redraw"));
+    data->nevents_pos = packer_array_placeholder(b);
+    data->nevents = 0;
+    data->cur_event = NULL;
+  }
 
   // To optimize data transfer(especially for "put"), we bundle adjacent
   // calls to same method together, so only add a new call entry if the last
   // method call is different from "name"
-  if (kv_size(data->buffer)) {
-    call = kv_A(data->buffer, kv_size(data->buffer) - 1).data.array;
+  if (!data->cur_event || strcmp(data->cur_event, name)) {
+    if (data->cur_event) {
+      packer_array_patch(b, data->ncalls_pos, data->ncalls);
+    }
+    data->ncalls_pos = packer_array_placeholder(b);
+    data->ncalls = 1;
+    data->nevents++;
+    data->cur_event = name;
+    packer_str(b, name, strlen(name));
   }
 
-  if (!kv_size(call) || strcmp(kv_A(call, 0).data.string.data, name)) {
-    call = (Array)ARRAY_DICT_INIT;
-    ADD(data->buffer, ARRAY_OBJ(call));
-    ADD(call, STRING_OBJ(cstr_to_string(name)));
-  }
+  data->ncalls++;
+  return b;
+}
 
-  ADD(call, ARRAY_OBJ(args));
-  kv_A(data->buffer, kv_size(data->buffer) - 1).data.array = call;
+/// Pushes data into UI.UIData, to be consumed later by remote_ui_flush().
+/// Takes ownership of `args`.
+static void push_call(UI *ui, const char *name, Array args)
+{
+  PackerBuffer *b = prepare_call(ui, name);
+  packer_array_items(b, args);
+  api_free_array(args);
 }
 
 static void remote_ui_grid_clear(UI *ui, Integer grid)
@@ -538,11 +598,11 @@ static void remote_ui_highlight_set(UI *ui, int id)
 static void remote_ui_grid_cursor_goto(UI *ui, Integer grid, Integer row, Integer col)
 {
   if (ui->ui_ext[kUILinegrid]) {
-    Array args = ARRAY_DICT_INIT;
-    ADD(args, INTEGER_OBJ(grid));
-    ADD(args, INTEGER_OBJ(row));
-    ADD(args, INTEGER_OBJ(col));
-    push_call(ui, "grid_cursor_goto", args);
+    PackerBuffer *b = prepare_call(ui, "grid_cursor_goto");
+    packer_array(b, 3);
+    packer_integer(b, grid);
+    packer_integer(b, row);
+    packer_integer(b, col);
   } else {
     UIData *data = ui->data;
     data->cursor_row = row;
@@ -580,12 +640,18 @@ static void remote_ui_raw_line(UI *ui, Integer grid, Integer row, Integer startc
                                const schar_T *chunk, const sattr_T *attrs)
 {
   UIData *data = ui->data;
-  if (ui->ui_ext[kUILinegrid]) {
-    Array args = ARRAY_DICT_INIT;
-    ADD(args, INTEGER_OBJ(grid));
-    ADD(args, INTEGER_OBJ(row));
-    ADD(args, INTEGER_OBJ(startcol));
-    Array cells = ARRAY_DICT_INIT;
+  if (ui->ui_ext[kUIGridBinary]) {
+    remote_ui_raw_line_binary(ui, grid, row, startcol, endcol, clearcol, clearattr, chunk,
+                              attrs);
+  } else if (ui->ui_ext[kUILinegrid]) {
+    // Written directly, this is the bulk of the redraw events.
+    PackerBuffer *b = prepare_call(ui, "grid_line");
+    packer_array(b, 4);
+    packer_integer(b, grid);
+    packer_integer(b, row);
+    packer_integer(b, startcol);
+    size_t cells_pos = packer_array_placeholder(b);
+    uint32_t ncells_packed = 0;
     int repeat = 0;
     size_t ncells = (size_t)(endcol-startcol);
     int last_hl = -1;
@@ -593,29 +659,28 @@ static void remote_ui_raw_line(UI *ui, Integer grid, Integer row, Integer startc
       repeat++;
       if (i == ncells-1 || attrs[i] != attrs[i+1]
           || STRCMP(chunk[i], chunk[i+1])) {
-        Array cell = ARRAY_DICT_INIT;
-        ADD(cell, STRING_OBJ(cstr_to_string((const char *)chunk[i])));
-        if (attrs[i] != last_hl || repeat > 1) {
-          ADD(cell, INTEGER_OBJ(attrs[i]));
+        bool send_hl = attrs[i] != last_hl || repeat > 1;
+        packer_array(b, 1 + (send_hl ? 1 : 0) + (repeat > 1 ? 1 : 0));
+        packer_str(b, (const char *)chunk[i], STRLEN(chunk[i]));
+        if (send_hl) {
+          packer_integer(b, attrs[i]);
           last_hl = attrs[i];
         }
         if (repeat > 1) {
-          ADD(cell, INTEGER_OBJ(repeat));
+          packer_integer(b, repeat);
         }
-        ADD(cells, ARRAY_OBJ(cell));
+        ncells_packed++;
         repeat = 0;
       }
     }
     if (endcol < clearcol) {
-      Array cell = ARRAY_DICT_INIT;
-      ADD(cell, STRING_OBJ(cstr_to_string(" ")));
-      ADD(cell, INTEGER_OBJ(clearattr));
-      ADD(cell, INTEGER_OBJ(clearcol-endcol));
-      ADD(cells, ARRAY_OBJ(cell));
+      packer_array(b, 3);
+      packer_str(b, S_LEN(" "));
+      packer_integer(b, clearattr);
+      packer_integer(b, clearcol-endcol);
+      ncells_packed++;
     }
-    ADD(args, ARRAY_OBJ(cells));
-
-    push_call(ui, "grid_line", args);
+    packer_array_patch(b, cells_pos, ncells_packed);
   } else {
     for (int i = 0; i < endcol-startcol; i++) {
       remote_ui_cursor_goto(ui, row, startcol+i);
@@ -642,17 +707,158 @@ static void remote_ui_raw_line(UI *ui, Integer grid, Integer row, Integer startc
   }
 }
 
+typedef kvec_t(char) ByteBuf;
+
+/// Appends `n` as an unsigned LEB128 varint.
+static void put_varint(ByteBuf *buf, uint64_t n)
+{
+  while (n >= 0x80) {
+    kv_push(*buf, (char)((n & 0x7f) | 0x80));
+    n >>= 7;
+  }
+  kv_push(*buf, (char)n);
+}
+
+/// Appends the glyph code of `text`, see |ui-event-grid_line_binary|.
+static void put_glyph(ByteBuf *buf, Array *glyphs, const char *text)
+{
+  if ((uint8_t)text[0] > 0 && (uint8_t)text[0] < 0x80 && text[1] == NUL) {
+    kv_push(*buf, text[0]);
+    return;
+  }
+  int id = map_get(cstr_t, int)(&glyph_ids, text);
+  if (!id) {
+    String glyph = cstr_to_string(text);
+    ADD(*glyphs, STRING_OBJ(glyph));
+    id = (int)glyphs->size;
+    map_put(cstr_t, int)(&glyph_ids, glyph.data, id);
+  }
+  put_varint(buf, 0x80 + (uint64_t)(id - 1));
+}
+
+/// Sends a "grid_line_binary" event: cell texts as indices into a glyph table
+/// and run-length encoded highlight ids, see |ui-event-grid_line_binary|.
+static void remote_ui_raw_line_binary(UI *ui, Integer grid, Integer row, Integer startcol,
+                                      Integer endcol, Integer clearcol, Integer clearattr,
+                                      const schar_T *chunk, const sattr_T *attrs)
+{
+  size_t ncells = (size_t)(endcol - startcol);
+  size_t nclear = endcol < clearcol ? (size_t)(clearcol - endcol) : 0;
+  ByteBuf buf = KV_INITIAL_VALUE;
+  Array glyphs = ARRAY_DICT_INIT;
+  put_varint(&buf, ncells + nclear);
+
+  size_t repeat = 0;
+  for (size_t i = 0; i < ncells; i++) {
+    if (i > 0 && !STRCMP(chunk[i], chunk[i - 1])) {
+      repeat++;
+      continue;
+    }
+    if (repeat) {
+      kv_push(buf, NUL);
+      put_varint(&buf, repeat);
+      repeat = 0;
+    }
+    put_glyph(&buf, &glyphs, (const char *)chunk[i]);
+  }
+  if (repeat) {
+    kv_push(buf, NUL);
+    put_varint(&buf, repeat);
+  }
+  if (nclear) {
+    kv_push(buf, ' ');
+    if (nclear > 1) {
+      kv_push(buf, NUL);
+      put_varint(&buf, nclear - 1);
+    }
+  }
+
+  size_t run = 0;
+  for (size_t i = 0; i < ncells; i++) {
+    run++;
+    if (i == ncells - 1 || attrs[i] != attrs[i + 1]) {
+      put_varint(&buf, (uint64_t)attrs[i]);
+      put_varint(&buf, run);
+      run = 0;
+    }
+  }
+  if (nclear) {
+    put_varint(&buf, (uint64_t)clearattr);
+    put_varint(&buf, nclear);
+  }
+
+  PackerBuffer *b = prepare_call(ui, "grid_line_binary");
+  packer_array(b, 5);
+  packer_integer(b, grid);
+  packer_integer(b, row);
+  packer_integer(b, startcol);
+  packer_array_items(b, glyphs);
+  packer_str(b, buf.items, buf.size);
+  map_clear(cstr_t, int)(&glyph_ids);
+  api_free_array(glyphs);
+  kv_destroy(buf);
+}
+
 static void remote_ui_flush(UI *ui)
 {
   UIData *data = ui->data;
-  if (data->buffer.size > 0) {
+  if (packer_size(&data->buf) > 0) {
+    data->frames++;
+    size_t lag = rpc_pending_bytes(data->channel_id);
+    data->lag_max = MAX(data->lag_max, lag);
+    // If the client doesn't read its redraw events fast enough, drop them
+    // instead of queueing them without bound. Once it has caught up, it gets
+    // a full refresh, like after attaching. Messages can't be sent again, so
+    // this isn't done for ext_messages.
+    if (data->lag_limit && !ui->ui_ext[kUIMessages]
+        && (data->resync_pending || lag > data->lag_limit)) {
+      packer_free(&data->buf);
+      data->frames_dropped++;
+      data->resync_pending = true;
+      // The client missed the updates of the legacy state, send it again.
+      data->hl_id = 0;
+      data->client_row = data->client_col = -1;
+      data->wildmenu_active = false;
+      remote_ui_output_written(data->channel_id, lag);
+      return;
+    }
     if (!ui->ui_ext[kUILinegrid]) {
       remote_ui_cursor_goto(ui, data->cursor_row, data->cursor_col);
     }
     push_call(ui, "flush", (Array)ARRAY_DICT_INIT);
-    rpc_send_event(data->channel_id, "redraw", data->buffer);
-    data->buffer = (Array)ARRAY_DICT_INIT;
+    packer_array_patch(&data->buf, data->ncalls_pos, data->ncalls);
+    packer_array_patch(&data->buf, data->nevents_pos, data->nevents);
+    rpc_send_packed(data->channel_id, &data->buf);
+  }
+}
+
+/// Called when output to the channel `channel_id` was written, `pending` is
+/// the number of bytes still to be written.
+void remote_ui_output_written(uint64_t channel_id, size_t pending)
+{
+  UI *ui = pmap_get(uint64_t)(&connected_uis, channel_id);
+  if (!ui) {
+    return;
   }
+  UIData *data = ui->data;
+  if (data->resync_pending && !data->resync_scheduled
+      && pending <= data->lag_limit / 2) {
+    data->resync_scheduled = true;
+    multiqueue_put(main_loop.events, remote_ui_resync_event, 0);
+  }
+}
+
+static void remote_ui_resync_event(void **argv)
+{
+  UI *ui;
+  map_foreach_value(&connected_uis, ui, {
+    UIData *data = ui->data;
+    if (data->resync_scheduled) {
+      data->resync_pending = false;
+      data->resync_scheduled = false;
+      ui_resync(ui);
+    }
+  });
 }
 
 static Array translate_contents(UI *ui, Array contents)
@@ -731,7 +937,7 @@ static void remote_ui_event(UI *ui, char *name, Array args, bool *args_consumed)
         if (args.items[1].data.integer != -1) {
           Array new_args2 = ARRAY_DICT_INIT;
           ADD(new_args2, args.items[1]);
-          push_call(ui, "wildmenu_select", new_args);
+          push_call(ui, "wildmenu_select", new_args2);
         }
         return;
       }
@@ -747,22 +953,19 @@ static void remote_ui_event(UI *ui, char *name, Array args, bool *args_consumed)
   }
 
 
-  Array my_args = ARRAY_DICT_INIT;
-  // Objects are currently single-reference
-  // make a copy, but only if necessary
-  if (*args_consumed) {
-    for (size_t i = 0; i < args.size; i++) {
-      ADD(my_args, copy_object(args.items[i]));
-    }
-  } else {
-    my_args = args;
-    *args_consumed = true;
-  }
-  push_call(ui, name, my_args);
+  // The arguments are packed right away and not kept, so they are never
+  // consumed: the next UI gets them too, and ui_event() frees them.
+  PackerBuffer *b = prepare_call(ui, name);
+  packer_array_items(b, args);
 }
 
 static void remote_ui_inspect(UI *ui, Dictionary *info)
 {
   UIData *data = ui->data;
   PUT(*info, "chan", INTEGER_OBJ((Integer)data->channel_id));
+  PUT(*info, "lag_limit", INTEGER_OBJ((Integer)data->lag_limit));
+  PUT(*info, "lag_bytes", INTEGER_OBJ((Integer)rpc_pending_bytes(data->channel_id)));
+  PUT(*info, "lag_max_bytes", INTEGER_OBJ((Integer)data->lag_max));
+  PUT(*info, "frames", INTEGER_OBJ(data->frames));
+  PUT(*info, "frames_dropped", INTEGER_OBJ(data->frames_dropped));
 }
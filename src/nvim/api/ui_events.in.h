@@ -29,7 +29,7 @@ void bell(void)
 void visual_bell(void)
   FUNC_API_SINCE(3);
 void flush(void)
-  FUNC_API_SINCE(3) FUNC_API_REMOTE_IMPL;
+  FUNC_API_SINCE(3) FUNC_API_REMOTE_IMPL FUNC_API_BRIDGE_IMPL;
 void suspend(void)
   FUNC_API_SINCE(3) FUNC_API_BRIDGE_IMPL;
 void set_title(String title)
@@ -37,7 +37,7 @@ void set_title(String title)
 void set_icon(String icon)
   FUNC_API_SINCE(3);
 void screenshot(String path)
-  FUNC_API_SINCE(7) FUNC_API_REMOTE_IMPL;
+  FUNC_API_SINCE(7) FUNC_API_REMOTE_IMPL FUNC_API_BRIDGE_IMPL;
 void option_set(String name, Object value)
   FUNC_API_SINCE(4) FUNC_API_BRIDGE_IMPL;
 // Stop event is not exported as such, represented by EOF in the msgpack stream.
@@ -85,6 +85,8 @@ void grid_cursor_goto(Integer grid, Integer row, Integer col)
   FUNC_API_SINCE(5) FUNC_API_REMOTE_IMPL FUNC_API_COMPOSITOR_IMPL;
 void grid_line(Integer grid, Integer row, Integer col_start, Array data)
   FUNC_API_SINCE(5) FUNC_API_REMOTE_ONLY;
+void grid_line_binary(Integer grid, Integer row, Integer col_start, Array glyphs, String data)
+  FUNC_API_SINCE(9) FUNC_API_REMOTE_ONLY FUNC_API_REMOTE_IMPL;
 void grid_scroll(Integer grid, Integer top, Integer bot,
                  Integer left, Integer right, Integer rows, Integer cols)
   FUNC_API_SINCE(5) FUNC_API_REMOTE_IMPL FUNC_API_COMPOSITOR_IMPL;
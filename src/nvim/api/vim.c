@@ -24,6 +24,7 @@
 #include "nvim/decoration.h"
 #include "nvim/edit.h"
 #include "nvim/eval.h"
+#include "nvim/eval/encode.h"
 #include "nvim/eval/typval.h"
 #include "nvim/eval/userfunc.h"
 #include "nvim/ex_cmds2.h"
@@ -45,6 +46,7 @@
 #include "nvim/ops.h"
 #include "nvim/option.h"
 #include "nvim/os/input.h"
+#include "nvim/os/os.h"
 #include "nvim/os/process.h"
 #include "nvim/popupmnu.h"
 #include "nvim/screen.h"
@@ -912,6 +914,7 @@ void nvim_err_writeln(String str)
 /// @return List of buffer handles
 ArrayOf(Buffer) nvim_list_bufs(void)
   FUNC_API_SINCE(1)
+  FUNC_API_READONLY
 {
   Array rv = ARRAY_DICT_INIT;
 
@@ -934,6 +937,7 @@ ArrayOf(Buffer) nvim_list_bufs(void)
 /// @return Buffer handle
 Buffer nvim_get_current_buf(void)
   FUNC_API_SINCE(1)
+  FUNC_API_READONLY
 {
   return curbuf->handle;
 }
@@ -1723,6 +1727,25 @@ void nvim_set_client_info(uint64_t channel_id, String name, Dictionary version,
 ///    -  "client"  (optional) Info about the peer (client on the other end of
 ///                 the RPC channel), if provided by it via
 ///                 |nvim_set_client_info()|.
+///    -  "stats"   (optional) Counters of the RPC channel, not included by
+///                 |nvim_list_chans()|:
+///         - "requests", "notifications"  Messages received.
+///         - "responses"  Responses received to requests sent by Nvim.
+///         - "bytes_in", "bytes_out"  Bytes received and sent.
+///         - "writes"  Write requests, each sends the messages queued while
+///                     the previous one was in flight.
+///         - "shm"     Messages go through shared memory, see |sockconnect()|.
+///         - "queue", "queue_max"  Requests waiting to be handled, now and
+///                                 at most.
+///         - "methods"  Dictionary of the called methods, each with:
+///           - "calls", "errors"  Calls, and calls which failed.
+///           - "time"   Nanoseconds spent in the method.
+///           - "handle_hist"  Histogram of the time spent in the method:
+///                            item `i` counts calls which took less than
+///                            2^i microseconds (and at least 2^(i-1)).
+///           - "response_hist"  Histogram like "handle_hist", of the time
+///                              from receiving a request to writing the
+///                              response.
 ///
 Dictionary nvim_get_chan_info(Integer chan, Error *err)
   FUNC_API_SINCE(4)
@@ -1730,7 +1753,7 @@ Dictionary nvim_get_chan_info(Integer chan, Error *err)
   if (chan < 0) {
     return (Dictionary)ARRAY_DICT_INIT;
   }
-  return channel_info((uint64_t)chan);
+  return channel_info((uint64_t)chan, true);
 }
 
 /// Get information about all open channels.
@@ -1810,7 +1833,7 @@ Array nvim_call_atomic(uint64_t channel_id, Array calls, Error *err)
     if (ERROR_SET(&nested_error)) {
       break;
     }
-    Object result = handler.fn(channel_id, args, &nested_error);
+    Object result = handler.fn(channel_id, args, NULL, &nested_error);
     if (ERROR_SET(&nested_error)) {
       // error handled after loop
       break;
@@ -1927,6 +1950,22 @@ Float nvim__id_float(Float flt)
   return flt;
 }
 
+/// Switches the calling channel to shared memory.
+///
+/// Used by |sockconnect()| for local socket connections: the client creates
+/// the file at {path}, the server maps it and uses it for all messages after
+/// the response to this request. The client must not send anything before
+/// it got the response.
+///
+/// @param channel_id
+/// @param path File created by the client, which removes it afterwards.
+/// @param[out] err Error details, if the file could not be mapped.
+void nvim__chan_shm(uint64_t channel_id, String path, Error *err)
+  FUNC_API_REMOTE_ONLY
+{
+  rpc_shm_attach(channel_id, path.data, err);
+}
+
 /// Gets internal stats.
 ///
 /// @return Map of various internal stats.
@@ -1935,10 +1974,140 @@ Dictionary nvim__stats(void)
   Dictionary rv = ARRAY_DICT_INIT;
   PUT(rv, "fsync", INTEGER_OBJ(g_stats.fsync));
   PUT(rv, "redraw", INTEGER_OBJ(g_stats.redraw));
+  PUT(rv, "tui_writes", INTEGER_OBJ(STATS_LOAD(&g_stats.tui_writes)));
+  PUT(rv, "tui_bytes", INTEGER_OBJ(STATS_LOAD(&g_stats.tui_bytes)));
+  PUT(rv, "tui_frame_bytes", INTEGER_OBJ(STATS_LOAD(&g_stats.tui_frame_bytes)));
+  PUT(rv, "term_bytes", INTEGER_OBJ(g_stats.term_bytes));
+  PUT(rv, "term_damage", INTEGER_OBJ(g_stats.term_damage));
+  PUT(rv, "term_refreshes", INTEGER_OBJ(g_stats.term_refreshes));
   PUT(rv, "lua_refcount", INTEGER_OBJ(nlua_refcount));
+  PUT(rv, "rpc", ARRAY_OBJ(channel_rpc_stats()));
+  PUT(rv, "events", DICTIONARY_OBJ(event_stats()));
   return rv;
 }
 
+/// Gets the statistics of the main loop events, see nvim__event_stats().
+static Dictionary event_stats(void)
+{
+  LoopStats *stats = main_loop.stats;
+  Dictionary rv = ARRAY_DICT_INIT;
+  PUT(rv, "enabled", BOOLEAN_OBJ(stats != NULL));
+  if (!stats) {
+    return rv;
+  }
+  PUT(rv, "threshold", INTEGER_OBJ((Integer)stats->threshold));
+
+  Dictionary handlers = ARRAY_DICT_INIT;
+  for (size_t i = 0; i < kv_size(stats->handlers); i++) {
+    LoopHandlerStats *h = &kv_A(stats->handlers, i);
+    Dictionary handler = ARRAY_DICT_INIT;
+    PUT(handler, "count", INTEGER_OBJ((Integer)h->count));
+    PUT(handler, "time", INTEGER_OBJ((Integer)h->time));
+    PUT(handler, "max", INTEGER_OBJ((Integer)h->max));
+    PUT(handler, "slow", INTEGER_OBJ((Integer)h->slow));
+    PUT(handlers, h->name, DICTIONARY_OBJ(handler));
+  }
+  PUT(rv, "handlers", DICTIONARY_OBJ(handlers));
+
+  Array slow = ARRAY_DICT_INIT;
+  uint64_t first = stats->slow_count - MIN(stats->slow_count, LOOP_SLOW_EVENTS);
+  for (uint64_t i = first; i < stats->slow_count; i++) {
+    LoopSlowEvent *ev = &stats->slow[i % LOOP_SLOW_EVENTS];
+    Dictionary event = ARRAY_DICT_INIT;
+    PUT(event, "name", STRING_OBJ(cstr_to_string(ev->name)));
+    PUT(event, "start", INTEGER_OBJ((Integer)ev->start));
+    PUT(event, "time", INTEGER_OBJ((Integer)ev->time));
+    ADD(slow, DICTIONARY_OBJ(event));
+  }
+  PUT(rv, "slow", ARRAY_OBJ(slow));
+
+  Dictionary input = ARRAY_DICT_INIT;
+  PUT(input, "count", INTEGER_OBJ((Integer)stats->input_count));
+  PUT(input, "time", INTEGER_OBJ((Integer)stats->input_time));
+  PUT(input, "max", INTEGER_OBJ((Integer)stats->input_max));
+  PUT(rv, "input_latency", DICTIONARY_OBJ(input));
+  return rv;
+}
+
+/// Times the handlers of main loop events, for finding what blocks the
+/// editor. The results are in nvim__stats().events:
+///   - "enabled"  Whether handlers are timed.
+///   - "threshold"  See below.
+///   - "handlers"  Map of handler names to dictionaries with "count", "time"
+///     (total), "max" and "slow" (count of slow events).
+///   - "slow"  The latest 64 slow events, oldest first, with "name", "start"
+///     (monotonic time) and "time".
+///   - "input_latency"  "count", "time" (total) and "max" of the time from
+///     input arriving to the screen being flushed after it was handled.
+///
+/// All times are in nanoseconds.
+///
+/// @param opts  Options:
+///   - enable: true to start timing, false to stop and discard the results.
+///   - threshold: handlers that run longer are slow events, default
+///     10000000 (10 ms).
+///   - dump: writes nvim__stats().events as JSON to this file.
+/// @param[out] err Error details, if any
+void nvim__event_stats(Dictionary opts, Error *err)
+{
+  bool enable = main_loop.stats != NULL;
+  Integer threshold = enable ? (Integer)main_loop.stats->threshold : 10000000;
+  String dump = NULL_STRING;
+  for (size_t i = 0; i < opts.size; i++) {
+    String k = opts.items[i].key;
+    Object *v = &opts.items[i].value;
+    if (strequal("enable", k.data)) {
+      if (v->type != kObjectTypeBoolean) {
+        api_set_error(err, kErrorTypeValidation, "enable must be a Boolean");
+        return;
+      }
+      enable = v->data.boolean;
+    } else if (strequal("threshold", k.data)) {
+      if (v->type != kObjectTypeInteger || v->data.integer < 0) {
+        api_set_error(err, kErrorTypeValidation, "threshold must be a non-negative Integer");
+        return;
+      }
+      threshold = v->data.integer;
+    } else if (strequal("dump", k.data)) {
+      if (v->type != kObjectTypeString) {
+        api_set_error(err, kErrorTypeValidation, "dump must be a String");
+        return;
+      }
+      dump = v->data.string;
+    } else {
+      api_set_error(err, kErrorTypeValidation, "unexpected key: %s", k.data);
+      return;
+    }
+  }
+
+  if (enable) {
+    loop_stats_start(&main_loop, (uint64_t)threshold);
+  } else {
+    loop_stats_stop(&main_loop);
+  }
+
+  if (dump.data) {
+    Object stats = DICTIONARY_OBJ(event_stats());
+    typval_T tv;
+    bool ok = object_to_vim(stats, &tv, err);
+    api_free_object(stats);
+    if (!ok) {
+      return;
+    }
+    size_t len;
+    char *json = encode_tv2json(&tv, &len);
+    tv_clear(&tv);
+    FILE *f = os_fopen(dump.data, "w");
+    if (!f || fwrite(json, 1, len, f) != len) {
+      api_set_error(err, kErrorTypeException, "Failed to write %s", dump.data);
+    }
+    if (f) {
+      fclose(f);
+    }
+    xfree(json);
+  }
+}
+
 /// Gets a list of dictionaries representing attached UIs.
 ///
 /// @return Array of UI dictionaries, each with these keys:
@@ -1947,6 +2116,11 @@ Dictionary nvim__stats(void)
 ///   - "rgb"     true if the UI uses RGB colors (false implies |cterm-colors|)
 ///   - "ext_..." Requested UI extensions, see |ui-option|
 ///   - "chan"    Channel id of remote UI (not present for TUI)
+///   - "lag_limit" |ui-lag_limit| of remote UI
+///   - "lag_bytes" Redraw data not yet read by remote UI
+///   - "lag_max_bytes" Highest "lag_bytes" seen so far
+///   - "frames"  Number of redraw batches for remote UI
+///   - "frames_dropped" Number of batches dropped because of |ui-lag_limit|
 Array nvim_list_uis(void)
   FUNC_API_SINCE(4)
 {
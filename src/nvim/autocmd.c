@@ -17,6 +17,7 @@
 #include "nvim/getchar.h"
 #include "nvim/option.h"
 #include "nvim/os/input.h"
+#include "nvim/profile.h"
 #include "nvim/regexp.h"
 #include "nvim/search.h"
 #include "nvim/state.h"
@@ -1574,6 +1575,8 @@ static bool apply_autocmds_group(event_T event, char_u *fname, char_u *fname_io,
     did_filetype = keep_filetype;
   }
 
+  TRACE_BEGIN("autocmd", "%s %s", event_nr2name(event), (char *)fname);
+
   // Note that we are applying autocmds.  Some commands need to know.
   autocmd_busy = true;
   filechangeshell_busy = (event == EVENT_FILECHANGEDSHELL);
@@ -1661,6 +1664,7 @@ static bool apply_autocmds_group(event_T event, char_u *fname, char_u *fname_io,
   if (do_profiling == PROF_YES) {
     prof_child_exit(&wait_time);
   }
+  TRACE_END();
   KeyTyped = save_KeyTyped;
   xfree(fname);
   xfree(sfname);
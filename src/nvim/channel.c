@@ -9,6 +9,7 @@
 #include "nvim/eval/encode.h"
 #include "nvim/event/socket.h"
 #include "nvim/fileio.h"
+#include "nvim/lua/converter.h"
 #include "nvim/lua/executor.h"
 #include "nvim/msgpack_rpc/channel.h"
 #include "nvim/msgpack_rpc/server.h"
@@ -195,7 +196,7 @@ void channel_create_event(Channel *chan, const char *ext_source)
   }
 
   assert(chan->id <= VARNUMBER_MAX);
-  Dictionary info = channel_info(chan->id);
+  Dictionary info = channel_info(chan->id, false);
   typval_T tv = TV_INITIAL_VALUE;
   // TODO(bfredl): do the conversion in one step. Also would be nice
   // to pretty print top level dict in defined order
@@ -229,11 +230,12 @@ void callback_reader_free(CallbackReader *reader)
 {
   callback_free(&reader->cb);
   ga_clear(&reader->buffer);
+  throttle_free(&reader->throttle);
 }
 
 void callback_reader_start(CallbackReader *reader, const char *type)
 {
-  ga_init(&reader->buffer, sizeof(char *), 32);
+  ga_init(&reader->buffer, 1, 32);
   reader->type = type;
 }
 
@@ -411,8 +413,8 @@ Channel *channel_job_start(char **argv, CallbackReader on_stdout, CallbackReader
 }
 
 
-uint64_t channel_connect(bool tcp, const char *address, bool rpc, CallbackReader on_output,
-                         int timeout, const char **error)
+uint64_t channel_connect(bool tcp, const char *address, bool rpc, bool shm,
+                         CallbackReader on_output, int timeout, const char **error)
 {
   Channel *channel;
 
@@ -444,6 +446,9 @@ uint64_t channel_connect(bool tcp, const char *address, bool rpc, CallbackReader
 
   if (rpc) {
     rpc_start(channel);
+    if (shm && !tcp) {
+      rpc_shm_connect(channel);
+    }
   } else {
     channel->on_data = on_output;
     callback_reader_start(&channel->on_data, "data");
@@ -610,15 +615,40 @@ static void on_channel_output(Stream *stream, Channel *chan, RBuffer *buf, size_
 
   if (eof) {
     reader->eof = true;
+    // Pass the tail of the output, if it was skipped by the throttle.
+    const char *skipped;
+    size_t skipped_len = throttle_end(&reader->throttle, &skipped);
+    if (skipped_len) {
+      ga_concat_len(&reader->buffer, skipped, skipped_len);
+    }
   } else {
     if (chan->term) {
       terminal_receive(chan->term, ptr, count);
     }
 
-    rbuffer_consumed(buf, count);
+    char *data = NULL;
+    // Buffered readers pass all output, they are never throttled.
+    if (callback_reader_set(*reader)
+        && (reader->buffered || !throttle_skip(&reader->throttle, ptr, count))) {
+      // Keep a large chunk instead of copying it, if nothing is buffered yet.
+      if (!reader->buffer.ga_len && count >= rbuffer_capacity(buf) / 2
+          && (data = rstream_take(stream, count))) {
+        ga_clear(&reader->buffer);
+        reader->buffer.ga_data = data;
+        reader->buffer.ga_len = (int)count;
+        reader->buffer.ga_maxlen = (int)rbuffer_capacity(buf);
+      } else {
+        ga_concat_len(&reader->buffer, ptr, count);
+      }
+    }
 
-    if (callback_reader_set(*reader)) {
-      ga_concat_len(&reader->buffer, ptr, count);
+    if (!data) {
+      rbuffer_consumed(buf, count);
+    }
+    // If nothing else is queued, start over at the beginning of the buffer,
+    // so that the next reads are not split at its end.
+    if (!rbuffer_size(buf)) {
+      rbuffer_reset(buf);
     }
   }
 
@@ -670,10 +700,10 @@ void channel_reader_callbacks(Channel *chan, CallbackReader *reader)
     if (reader->eof) {
       if (reader->self) {
         if (tv_dict_find(reader->self, reader->type, -1) == NULL) {
-          list_T *data = buffer_to_tv_list(reader->buffer.ga_data,
-                                           (size_t)reader->buffer.ga_len);
-          tv_dict_add_list(reader->self, reader->type, strlen(reader->type),
-                           data);
+          typval_T data;
+          callback_reader_take_tv(reader, &data);
+          tv_dict_add_tv(reader->self, reader->type, strlen(reader->type), &data);
+          tv_clear(&data);
         } else {
           semsg(_(e_streamkey), reader->type, chan->id);
         }
@@ -712,6 +742,49 @@ static void channel_process_exit_cb(Process *proc, int status, void *data)
   channel_decref(chan);
 }
 
+/// Moves the data gathered by a reader to `tv`: a Blob in "bytes" data_mode,
+/// otherwise a list of lines.
+static void callback_reader_take_tv(CallbackReader *reader, typval_T *tv)
+{
+  tv->v_lock = VAR_UNLOCKED;
+  if (reader->bytes) {
+    // The Blob takes the memory, which may come from rstream_take().
+    blob_T *blob = tv_blob_alloc();
+    blob->bv_ga = reader->buffer;
+    ga_init(&reader->buffer, 1, 32);
+    tv_blob_set_ret(tv, blob);
+  } else {
+    tv->v_type = VAR_LIST;
+    tv->vval.v_list = buffer_to_tv_list(reader->buffer.ga_data, (size_t)reader->buffer.ga_len);
+    tv_list_ref(tv->vval.v_list);
+    ga_clear(&reader->buffer);
+  }
+}
+
+/// Passes the data gathered by a reader to a Lua callback as a Lua string,
+/// without a Blob in between.
+///
+/// @return false if the callback is not a Lua function.
+static bool callback_reader_call_lua(Channel *chan, CallbackReader *reader)
+{
+  if (reader->cb.type != kCallbackFuncref) {
+    return false;
+  }
+  LuaRef ref = nlua_funcref_luaref(reader->cb.data.funcref);
+  if (ref == LUA_NOREF) {
+    return false;
+  }
+  Object args[] = {
+    INTEGER_OBJ((Integer)chan->id),
+    STRING_OBJ(((String){ .data = reader->buffer.ga_len ? reader->buffer.ga_data : "",
+                          .size = (size_t)reader->buffer.ga_len })),
+    STRING_OBJ(cstr_as_string((char *)reader->type)),
+  };
+  nlua_call_ref(ref, NULL, (Array){ .items = args, .size = ARRAY_SIZE(args) }, false, NULL);
+  ga_clear(&reader->buffer);
+  return true;
+}
+
 static void channel_callback_call(Channel *chan, CallbackReader *reader)
 {
   Callback *cb;
@@ -722,12 +795,10 @@ static void channel_callback_call(Channel *chan, CallbackReader *reader)
   argv[0].vval.v_number = (varnumber_T)chan->id;
 
   if (reader) {
-    argv[1].v_type = VAR_LIST;
-    argv[1].v_lock = VAR_UNLOCKED;
-    argv[1].vval.v_list = buffer_to_tv_list(reader->buffer.ga_data,
-                                            (size_t)reader->buffer.ga_len);
-    tv_list_ref(argv[1].vval.v_list);
-    ga_clear(&reader->buffer);
+    if (reader->bytes && callback_reader_call_lua(chan, reader)) {
+      return;
+    }
+    callback_reader_take_tv(reader, &argv[1]);
     cb = &reader->cb;
     argv[2].vval.v_string = (char_u *)reader->type;
   } else {
@@ -822,7 +893,7 @@ static void set_info_event(void **argv)
 
   save_v_event_T save_v_event;
   dict_T *dict = get_v_event(&save_v_event);
-  Dictionary info = channel_info(chan->id);
+  Dictionary info = channel_info(chan->id, false);
   typval_T retval;
   (void)object_to_vim(DICTIONARY_OBJ(info), &retval, NULL);
   tv_dict_add_dict(dict, S_LEN("info"), retval.vval.v_dict);
@@ -842,7 +913,8 @@ bool channel_job_running(uint64_t id)
           && !process_is_stopped(&chan->stream.proc));
 }
 
-Dictionary channel_info(uint64_t id)
+/// @param stats  Include the counters of an RPC channel.
+Dictionary channel_info(uint64_t id, bool stats)
 {
   Channel *chan = find_channel(id);
   if (!chan) {
@@ -897,6 +969,9 @@ Dictionary channel_info(uint64_t id)
   if (chan->is_rpc) {
     mode_desc = "rpc";
     PUT(info, "client", DICTIONARY_OBJ(rpc_client_info(chan)));
+    if (stats) {
+      PUT(info, "stats", DICTIONARY_OBJ(rpc_stats(chan)));
+    }
   } else if (chan->term) {
     mode_desc = "terminal";
     PUT(info, "buffer", BUFFER_OBJ(terminal_buf(chan->term)));
@@ -913,7 +988,22 @@ Array channel_all_info(void)
   Channel *channel;
   Array ret = ARRAY_DICT_INIT;
   map_foreach_value(&channels, channel, {
-    ADD(ret, DICTIONARY_OBJ(channel_info(channel->id)));
+    ADD(ret, DICTIONARY_OBJ(channel_info(channel->id, false)));
+  });
+  return ret;
+}
+
+/// Gets the counters of all RPC channels, see rpc_stats().
+Array channel_rpc_stats(void)
+{
+  Channel *channel;
+  Array ret = ARRAY_DICT_INIT;
+  map_foreach_value(&channels, channel, {
+    if (channel->is_rpc) {
+      Dictionary stats = rpc_stats(channel);
+      PUT(stats, "id", INTEGER_OBJ((Integer)channel->id));
+      ADD(ret, DICTIONARY_OBJ(stats));
+    }
   });
   return ret;
 }
@@ -5,6 +5,7 @@
 #include "nvim/event/libuv_process.h"
 #include "nvim/event/process.h"
 #include "nvim/event/socket.h"
+#include "nvim/event/throttle.h"
 #include "nvim/main.h"
 #include "nvim/msgpack_rpc/channel_defs.h"
 #include "nvim/os/pty_process.h"
@@ -52,6 +53,8 @@ typedef struct {
   garray_T buffer;
   bool eof;
   bool buffered;
+  bool bytes;  ///< Pass the data as a Blob (a string to Lua), not lines.
+  Throttle throttle;  ///< Skips output above a threshold, if enabled.
   const char *type;
 } CallbackReader;
 
@@ -59,6 +62,8 @@ typedef struct {
                                                 .self = NULL, \
                                                 .buffer = GA_EMPTY_INIT_VALUE, \
                                                 .buffered = false, \
+                                                .bytes = false, \
+                                                .throttle = THROTTLE_INIT, \
                                                 .type = NULL })
 static inline bool callback_reader_set(CallbackReader reader)
 {
@@ -120,6 +120,13 @@ typedef struct {
   int fi_byte_idx;              // byte index in fi_string
 } forinfo_T;
 
+/// State of systemlist() with an "on_lines" callback.
+typedef struct {
+  Callback cb;
+  list_T *lines;  ///< Lines not passed yet, the last one is incomplete.
+  bool any;       ///< Any output was received.
+} SystemListStream;
+
 // values for vv_flags:
 #define VV_COMPAT       1       // compatible, also used without "v:"
 #define VV_RO           2       // read-only
@@ -7621,6 +7628,42 @@ static list_T *string_to_list(const char *str, size_t len, const bool keepempty)
   return list;
 }
 
+/// Passes the complete lines of the output to the "on_lines" callback of
+/// systemlist().
+static void systemlist_stream_cb(const char *output, size_t len, void *data)
+{
+  SystemListStream *stream = data;
+  stream->any = true;
+  encode_list_write(stream->lines, output, len);
+  if (tv_list_len(stream->lines) > 1) {
+    // Keep the incomplete last line for the next chunk.
+    listitem_T *const last = tv_list_last(stream->lines);
+    list_T *const rest = tv_list_alloc(kListLenUnknown);
+    tv_list_append_allocated_string(rest, (char *)TV_LIST_ITEM_TV(last)->vval.v_string);
+    TV_LIST_ITEM_TV(last)->vval.v_string = NULL;
+    tv_list_item_remove(stream->lines, last);
+    systemlist_stream_call(stream);
+    stream->lines = rest;
+  }
+}
+
+/// Invokes the "on_lines" callback of systemlist() with `stream->lines`,
+/// which is freed unless the callback keeps it.
+static void systemlist_stream_call(SystemListStream *stream)
+{
+  typval_T argv[1];
+  argv[0].v_type = VAR_LIST;
+  argv[0].v_lock = VAR_UNLOCKED;
+  argv[0].vval.v_list = stream->lines;
+  tv_list_ref(stream->lines);
+
+  typval_T rettv = TV_INITIAL_VALUE;
+  callback_call(&stream->cb, 1, argv, &rettv);
+  tv_clear(&rettv);
+  tv_list_unref(stream->lines);
+  stream->lines = NULL;
+}
+
 // os_system wrapper. Handles 'verbose', :profile, and v:shell_error.
 void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist)
 {
@@ -7634,11 +7677,27 @@ void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist
     return;
   }
 
+  bool keepempty = false;
+  SystemListStream stream = { .cb = CALLBACK_NONE, .lines = NULL, .any = false };
+  if (retlist && argvars[1].v_type != VAR_UNKNOWN && argvars[2].v_type != VAR_UNKNOWN) {
+    keepempty = (bool)tv_get_number(&argvars[2]);
+    if (argvars[3].v_type != VAR_UNKNOWN) {
+      if (argvars[3].v_type != VAR_DICT) {
+        emsg(_(e_dictreq));
+        return;
+      }
+      if (!tv_dict_get_callback(argvars[3].vval.v_dict, S_LEN("on_lines"), &stream.cb)) {
+        return;
+      }
+    }
+  }
+
   // get input to the shell command (if any), and its length
   ptrdiff_t input_len;
   char *input = save_tv_as_string(&argvars[1], &input_len, false);
   if (input_len < 0) {
     assert(input == NULL);
+    callback_free(&stream.cb);
     return;
   }
 
@@ -7650,6 +7709,7 @@ void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist
       set_vim_var_nr(VV_SHELL_ERROR, (long)-1);
     }
     xfree(input);
+    callback_free(&stream.cb);
     return;  // Already did emsg.
   }
 
@@ -7669,7 +7729,15 @@ void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist
   // execute the command
   size_t nread = 0;
   char *res = NULL;
-  int status = os_system(argv, input, input_len, &res, &nread);
+  int status;
+  if (stream.cb.type != kCallbackNone) {
+    // Pass the lines as they arrive, instead of returning all of them.
+    stream.lines = tv_list_alloc(kListLenUnknown);
+    tv_list_append_string(stream.lines, "", 0);
+    status = os_system_stream(argv, input, (size_t)input_len, systemlist_stream_cb, &stream);
+  } else {
+    status = os_system(argv, input, input_len, &res, &nread);
+  }
 
   if (profiling) {
     prof_child_exit(&wait_time);
@@ -7679,6 +7747,20 @@ void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist
 
   set_vim_var_nr(VV_SHELL_ERROR, (long)status);
 
+  if (stream.lines) {
+    // Pass the last line, like string_to_list() would return it.
+    const char *const last
+      = (const char *)TV_LIST_ITEM_TV(tv_list_last(stream.lines))->vval.v_string;
+    if ((last != NULL && *last != NUL) || (keepempty && stream.any)) {
+      systemlist_stream_call(&stream);
+    } else {
+      tv_list_free(stream.lines);
+    }
+    callback_free(&stream.cb);
+    tv_list_alloc_ret(rettv, 0);
+    return;
+  }
+
   if (res == NULL) {
     if (retlist) {
       // return an empty list when there's no output
@@ -7690,11 +7772,7 @@ void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist
   }
 
   if (retlist) {
-    int keepempty = 0;
-    if (argvars[1].v_type != VAR_UNKNOWN && argvars[2].v_type != VAR_UNKNOWN) {
-      keepempty = tv_get_number(&argvars[2]);
-    }
-    rettv->vval.v_list = string_to_list(res, nread, (bool)keepempty);
+    rettv->vval.v_list = string_to_list(res, nread, keepempty);
     tv_list_ref(rettv->vval.v_list);
     rettv->v_type = VAR_LIST;
 
@@ -11011,9 +11089,18 @@ char_u *do_string_sub(char_u *str, char_u *pat, char_u *sub, typval_T *expr, cha
 bool common_job_callbacks(dict_T *vopts, CallbackReader *on_stdout, CallbackReader *on_stderr,
                           Callback *on_exit)
 {
-  if (tv_dict_get_callback(vopts, S_LEN("on_stdout"), &on_stdout->cb)
-      && tv_dict_get_callback(vopts, S_LEN("on_stderr"), &on_stderr->cb)
-      && tv_dict_get_callback(vopts, S_LEN("on_exit"), on_exit)) {
+  const char *data_mode = tv_dict_get_string(vopts, "data_mode", false);
+  const varnumber_T throttle = tv_dict_get_number(vopts, "throttle");
+  if (data_mode && !strequal(data_mode, "lines") && !strequal(data_mode, "bytes")) {
+    semsg(_(e_invargNval), "data_mode", data_mode);
+  } else if (throttle < 0) {
+    semsg(_(e_invargval), "throttle");
+  } else if (tv_dict_get_callback(vopts, S_LEN("on_stdout"), &on_stdout->cb)
+             && tv_dict_get_callback(vopts, S_LEN("on_stderr"), &on_stderr->cb)
+             && tv_dict_get_callback(vopts, S_LEN("on_exit"), on_exit)) {
+    on_stdout->bytes = on_stderr->bytes = data_mode && strequal(data_mode, "bytes");
+    throttle_init(&on_stdout->throttle, (size_t)throttle);
+    throttle_init(&on_stderr->throttle, (size_t)throttle);
     on_stdout->buffered = tv_dict_get_number(vopts, "stdout_buffered");
     on_stderr->buffered = tv_dict_get_number(vopts, "stderr_buffered");
     if (on_stdout->buffered && on_stdout->cb.type == kCallbackNone) {
@@ -385,7 +385,7 @@ return {
     synconcealed={args=2},
     synstack={args=2},
     system={args={1, 2}, base=1},
-    systemlist={args={1, 3}, base=1},
+    systemlist={args={1, 4}, base=1},
     tabpagebuflist={args={0, 1}, base=1},
     tabpagenr={args={0, 1}},
     tabpagewinnr={args={1, 2}, base=1},
@@ -18,6 +18,7 @@
 #include "nvim/globals.h"
 #include "nvim/lua/executor.h"
 #include "nvim/os/input.h"
+#include "nvim/profile.h"
 #include "nvim/regexp.h"
 #include "nvim/search.h"
 #include "nvim/ui.h"
@@ -834,6 +835,11 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
     return;
   }
   ++depth;
+  if (fp->uf_name[0] == K_SPECIAL) {
+    TRACE_BEGIN("function", "<SNR>%s", (char *)fp->uf_name + 3);
+  } else {
+    TRACE_BEGIN("function", "%s", (char *)fp->uf_name);
+  }
   // Save search patterns and redo buffer.
   save_search_patterns();
   if (!ins_compl_active()) {
@@ -1201,6 +1207,7 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
 
   did_emsg |= save_did_emsg;
   depth--;
+  TRACE_END();
   for (int i = 0; i < tv_to_free_len; i++) {
     tv_clear(tv_to_free[i]);
   }
@@ -10,6 +10,7 @@ typedef void (*argv_callback)(void **argv);
 typedef struct message {
   argv_callback handler;
   void *argv[EVENT_HANDLER_MAX_ARGC];
+  const char *name;  ///< Name of the handler, see loop_stats_start().
 } Event;
 typedef void (*event_scheduler)(Event event, void *data);
 
@@ -27,11 +28,14 @@ typedef void (*event_scheduler)(Event event, void *data);
     } \
   } while (0)
 
-static inline Event event_create(argv_callback cb, int argc, ...)
+#define event_create(cb, ...) event_create_named(#cb, cb, __VA_ARGS__)
+
+static inline Event event_create_named(const char *name, argv_callback cb, int argc, ...)
 {
   assert(argc <= EVENT_HANDLER_MAX_ARGC);
   Event event;
   VA_EVENT_INIT(&event, cb, argc);
+  event.name = name;
   return event;
 }
 
@@ -4,6 +4,23 @@
 #include <assert.h>
 #include <uv.h>
 
+#include "auto/config.h"
+#if defined(HAVE_POSIX_SPAWN_SETSID) && defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP)
+# define USE_POSIX_SPAWN
+# include <errno.h>
+# include <fcntl.h>
+# include <signal.h>
+# include <spawn.h>
+# include <string.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <sys/wait.h>
+# include <unistd.h>
+# ifdef HAVE__NSGETENVIRON
+#  include <crt_externs.h>
+# endif
+#endif
+
 #include "nvim/event/libuv_process.h"
 #include "nvim/event/loop.h"
 #include "nvim/event/process.h"
@@ -11,7 +28,9 @@
 #include "nvim/event/wstream.h"
 #include "nvim/log.h"
 #include "nvim/macros.h"
+#include "nvim/memory.h"
 #include "nvim/os/os.h"
+#include "nvim/path.h"
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "event/libuv_process.c.generated.h"
@@ -80,6 +99,15 @@ int libuv_process_spawn(LibuvProcess *uvproc)
   }
 
   int status;
+#ifdef USE_POSIX_SPAWN
+  // uv_spawn() forks, which takes longer the more memory Nvim uses.
+  uvproc->spawned = true;
+  status = posix_spawn_process(uvproc);
+  if (uvproc->uvopts.env) {
+    os_free_fullenv(uvproc->uvopts.env);
+    uvproc->uvopts.env = NULL;
+  }
+#else
   if ((status = uv_spawn(&proc->loop->uv, &uvproc->uv, &uvproc->uvopts))) {
     ELOG("uv_spawn(%s) failed: %s", uvproc->uvopts.file, uv_strerror(status));
     if (uvproc->uvopts.env) {
@@ -89,12 +117,183 @@ int libuv_process_spawn(LibuvProcess *uvproc)
   }
 
   proc->pid = uvproc->uv.pid;
+#endif
+  return status;
+}
+
+#ifdef USE_POSIX_SPAWN
+/// Starts a process like uv_spawn() with the options prepared by
+/// libuv_process_spawn(), but with posix_spawn(), which does not copy the
+/// address space of Nvim (it uses vfork() or the like). The exit of the
+/// process is noticed by process_watch_children().
+///
+/// @returns zero on success, or negative error code
+static int posix_spawn_process(LibuvProcess *uvproc)
+  FUNC_ATTR_NONNULL_ALL
+{
+#ifdef HAVE__NSGETENVIRON
+  char **environ = *_NSGetEnviron();
+#else
+  extern char **environ;
+#endif
+  Process *proc = (Process *)uvproc;
+  int fds[3][2] = { { -1, -1 }, { -1, -1 }, { -1, -1 } };
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawnattr_init(&attr);
+
+  int status = 0;
+  for (int i = 0; i < 3; i++) {
+    uv_stdio_container_t *stdio = &uvproc->uvstdio[i];
+    if (!(stdio->flags & UV_CREATE_PIPE)) {
+      // Like uv_spawn(), which gives the child /dev/null instead.
+      status = -posix_spawn_file_actions_addopen(&actions, i, "/dev/null",
+                                                 i == 0 ? O_RDONLY : O_RDWR, 0);
+    } else if (!(status = uv_socketpair(SOCK_STREAM, 0, fds[i], 0, 0))) {
+      // Keep the end of the child away from 0-2, dup2() would not clear
+      // FD_CLOEXEC for the same descriptor, or clobber another one.
+      if (fds[i][1] <= STDERR_FILENO) {
+        int fd = fcntl(fds[i][1], F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+        close(fds[i][1]);
+        fds[i][1] = fd;
+        status = fd < 0 ? -errno : 0;
+      }
+      if (!status) {
+        status = -posix_spawn_file_actions_adddup2(&actions, fds[i][1], i);
+      }
+    }
+    if (status) {
+      goto cleanup;
+    }
+  }
+  if (proc->cwd
+      && (status = -posix_spawn_file_actions_addchdir_np(&actions, proc->cwd))) {
+    goto cleanup;
+  }
+
+  // Like uv_spawn(): a new session (#8107), and default signal handling.
+  sigset_t sigdefault, sigmask;
+  sigfillset(&sigdefault);
+  sigdelset(&sigdefault, SIGKILL);
+  sigdelset(&sigdefault, SIGSTOP);
+  sigemptyset(&sigmask);
+  posix_spawnattr_setsigdefault(&attr, &sigdefault);
+  posix_spawnattr_setsigmask(&attr, &sigmask);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGDEF
+                           | POSIX_SPAWN_SETSIGMASK);
+
+  char **env = uvproc->uvopts.env ? uvproc->uvopts.env : environ;
+  char *path = posix_spawn_find(proc->argv[0], env);
+  if (!path) {
+    status = UV_ENOENT;
+    ELOG("posix_spawn(%s) failed: %s", proc->argv[0], uv_strerror(status));
+    goto cleanup;
+  }
+
+  process_watch_children(proc->loop);
+  pid_t pid;
+  status = -posix_spawn(&pid, path, &actions, &attr, proc->argv, env);
+  if (status == -ENOEXEC) {
+    // Like execvp(): a file without "#!" is run by the shell.
+    size_t argc = 0;
+    while (proc->argv[argc]) {
+      argc++;
+    }
+    char **sh_argv = xmalloc((argc + 2) * sizeof(*sh_argv));
+    sh_argv[0] = (char *)"/bin/sh";
+    sh_argv[1] = path;
+    memcpy(sh_argv + 2, proc->argv + 1, argc * sizeof(*sh_argv));  // with NULL
+    status = -posix_spawn(&pid, "/bin/sh", &actions, &attr, sh_argv, env);
+    xfree(sh_argv);
+  }
+  xfree(path);
+  if (status) {
+    ELOG("posix_spawn(%s) failed: %s", proc->argv[0], uv_strerror(status));
+    goto cleanup;
+  }
+  proc->pid = pid;
+
+  uv_pipe_t *pipes[] = { &proc->in.uv.pipe, &proc->out.uv.pipe, &proc->err.uv.pipe };
+  for (int i = 0; i < 3; i++) {
+    if (fds[i][0] < 0) {
+      continue;
+    }
+    close(fds[i][1]);
+    fds[i][1] = -1;
+    if (!status && (status = uv_pipe_open(pipes[i], fds[i][0]))) {
+      ELOG("uv_pipe_open(%d) failed: %s", fds[i][0], uv_strerror(status));
+    }
+    if (!status) {
+      fds[i][0] = -1;  // Owned by the pipe.
+    }
+  }
+  if (status) {
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+  }
+
+cleanup:
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 2; j++) {
+      if (fds[i][j] >= 0) {
+        close(fds[i][j]);
+      }
+    }
+  }
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
   return status;
 }
 
+/// Finds the executable `name` in the $PATH of the environment `env`, like
+/// execvp() does in the child of uv_spawn() (not with the $PATH of Nvim).
+///
+/// @returns allocated path, or NULL if not found
+static char *posix_spawn_find(const char *name, char **env)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_MALLOC
+{
+  if (strchr(name, '/')) {
+    return xstrdup(name);
+  }
+
+  const char *path = "/bin:/usr/bin";  // Default of execvp().
+  for (char **var = env; *var; var++) {
+    if (strncmp(*var, "PATH=", 5) == 0) {
+      path = *var + 5;
+      break;
+    }
+  }
+
+  for (const char *dir = path;; dir++) {
+    const char *end = xstrchrnul(dir, ':');
+    // An empty entry is the current directory.
+    char *file = (end == dir
+                  ? xstrdup(name)
+                  : concat_fnames_realloc(xstrndup(dir, (size_t)(end - dir)), name, true));
+    struct stat st;
+    if (stat(file, &st) == 0 && S_ISREG(st.st_mode) && access(file, X_OK) == 0) {
+      return file;
+    }
+    xfree(file);
+    if (!*end) {
+      return NULL;
+    }
+    dir = end;
+  }
+}
+#endif
+
 void libuv_process_close(LibuvProcess *uvproc)
   FUNC_ATTR_NONNULL_ARG(1)
 {
+  if (uvproc->spawned) {
+    Process *proc = (Process *)uvproc;
+    if (proc->internal_close_cb) {
+      proc->internal_close_cb(proc);
+    }
+    return;
+  }
   uv_close((uv_handle_t *)&uvproc->uv, close_cb);
 }
 
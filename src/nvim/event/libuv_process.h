@@ -10,6 +10,7 @@ typedef struct libuv_process {
   uv_process_t uv;
   uv_process_options_t uvopts;
   uv_stdio_container_t uvstdio[3];
+  bool spawned;  ///< Started by posix_spawn(), `uv` is not used.
 } LibuvProcess;
 
 static inline LibuvProcess libuv_process_init(Loop *loop, void *data)
@@ -8,6 +8,9 @@
 #include "nvim/event/loop.h"
 #include "nvim/event/process.h"
 #include "nvim/log.h"
+#include "nvim/macros.h"
+#include "nvim/memory.h"
+#include "nvim/strings.h"
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "event/loop.c.generated.h"
@@ -18,10 +21,12 @@ void loop_init(Loop *loop, void *data)
 {
   uv_loop_init(&loop->uv);
   loop->recursive = 0;
+  loop->stats = NULL;
   loop->uv.data = loop;
   loop->children = kl_init(WatcherPtr);
   loop->events = multiqueue_new_parent(loop_on_put, loop);
   loop->fast_events = multiqueue_new_child(loop->events);
+  multiqueue_set_priority(loop->fast_events, kMultiQueuePriorityHigh);
   loop->thread_events = multiqueue_new_parent(NULL, NULL);
   uv_mutex_init(&loop->mutex);
   uv_async_init(&loop->uv, &loop->async, async_cb);
@@ -168,6 +173,7 @@ bool loop_close(Loop *loop, bool wait)
     }
 #endif
   }
+  loop_stats_stop(loop);
   multiqueue_free(loop->fast_events);
   multiqueue_free(loop->thread_events);
   multiqueue_free(loop->events);
@@ -213,3 +219,80 @@ static void timer_close_cb(uv_handle_t *handle)
 {
   xfree(handle->data);
 }
+
+/// Starts timing the handlers of the events processed from `Loop.events` and
+/// its children, or changes the threshold.
+///
+/// @param threshold  Events that take longer (nanoseconds) are kept as slow
+///                   events.
+void loop_stats_start(Loop *loop, uint64_t threshold)
+{
+  if (!loop->stats) {
+    loop->stats = xcalloc(1, sizeof(*loop->stats));
+    multiqueue_set_process_cb(loop->events, loop_stats_event);
+  }
+  loop->stats->threshold = threshold;
+}
+
+/// Stops timing the handlers and discards the statistics.
+void loop_stats_stop(Loop *loop)
+{
+  if (loop->stats) {
+    multiqueue_set_process_cb(loop->events, NULL);
+    kv_destroy(loop->stats->handlers);
+    XFREE_CLEAR(loop->stats);
+  }
+}
+
+static void loop_stats_event(void *data, const char *name, uint64_t start, uint64_t end)
+{
+  LoopStats *stats = ((Loop *)data)->stats;
+  if (!stats) {
+    return;  // Stopped by the handler.
+  }
+  name = name ? name : "?";
+  LoopHandlerStats *handler = NULL;
+  for (size_t i = 0; i < kv_size(stats->handlers); i++) {
+    LoopHandlerStats *h = &kv_A(stats->handlers, i);
+    if (h->name == name || strequal(h->name, name)) {
+      handler = h;
+      break;
+    }
+  }
+  if (!handler) {
+    kv_push(stats->handlers, ((LoopHandlerStats) { .name = name }));
+    handler = &kv_last(stats->handlers);
+  }
+  uint64_t time = end - start;
+  handler->count++;
+  handler->time += time;
+  handler->max = MAX(handler->max, time);
+  if (time > stats->threshold) {
+    handler->slow++;
+    stats->slow[stats->slow_count++ % LOOP_SLOW_EVENTS] = (LoopSlowEvent) {
+      .name = name, .start = start, .time = time
+    };
+  }
+}
+
+/// Notes that input arrived, see loop_stats_flush().
+void loop_stats_input(Loop *loop)
+{
+  if (loop->stats && !loop->stats->input_start) {
+    loop->stats->input_start = os_hrtime();
+  }
+}
+
+/// Records the time from the oldest input since the last call, after the
+/// screen was updated for it.
+void loop_stats_flush(Loop *loop)
+{
+  LoopStats *stats = loop->stats;
+  if (stats && stats->input_start) {
+    uint64_t time = os_hrtime() - stats->input_start;
+    stats->input_count++;
+    stats->input_time += time;
+    stats->input_max = MAX(stats->input_max, time);
+    stats->input_start = 0;
+  }
+}
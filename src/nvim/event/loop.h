@@ -5,11 +5,43 @@
 #include <uv.h>
 
 #include "nvim/event/multiqueue.h"
+#include "nvim/lib/kvec.h"
 #include "nvim/lib/klist.h"
 #include "nvim/os/time.h"
 
 typedef void *WatcherPtr;
 
+/// Number of slow events kept by LoopStats.
+#define LOOP_SLOW_EVENTS 64
+
+typedef struct {
+  const char *name;
+  uint64_t count;
+  uint64_t time;  ///< Total nanoseconds spent in the handler.
+  uint64_t max;
+  uint64_t slow;  ///< Events above the threshold.
+} LoopHandlerStats;
+
+typedef struct {
+  const char *name;
+  uint64_t start;  ///< os_hrtime() when the handler was called.
+  uint64_t time;
+} LoopSlowEvent;
+
+/// Statistics of the events processed from `Loop.events` and its children,
+/// see loop_stats_start().
+typedef struct {
+  uint64_t threshold;  ///< Nanoseconds, longer events are slow.
+  kvec_t(LoopHandlerStats) handlers;
+  LoopSlowEvent slow[LOOP_SLOW_EVENTS];  ///< The latest slow events.
+  uint64_t slow_count;
+  uint64_t input_start;  ///< os_hrtime() of the oldest input not yet
+                         ///< flushed, see loop_stats_flush(). 0 if none.
+  uint64_t input_count;  ///< Input-to-flush latencies.
+  uint64_t input_time;
+  uint64_t input_max;
+} LoopStats;
+
 #define _noop(x)
 KLIST_INIT(WatcherPtr, WatcherPtr, _noop)
 
@@ -39,12 +71,14 @@ typedef struct loop {
   uv_async_t async;
   uv_mutex_t mutex;
   int recursive;
+
+  LoopStats *stats;  ///< NULL unless loop_stats_start() was called.
 } Loop;
 
 #define CREATE_EVENT(multiqueue, handler, argc, ...) \
   do { \
     if (multiqueue) { \
-      multiqueue_put((multiqueue), (handler), argc, __VA_ARGS__); \
+      multiqueue_put((multiqueue), handler, argc, __VA_ARGS__); \
     } else { \
       void *argv[argc] = { __VA_ARGS__ }; \
       (handler)(argv); \
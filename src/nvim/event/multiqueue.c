@@ -44,36 +44,66 @@
 // the event loop queue and poll job1 queue instead. Same with channels, when
 // calling `rpcrequest` we want to temporarily stop processing events from
 // other sources and focus on a specific channel.
+//
+// Each queue stores its items in rings of Event-sized slots that grow as
+// needed, so putting an event does not allocate. A link in the parent queue
+// only says "the child queue has an event": when an event is removed from the
+// child queue directly, its link is not searched for, the child counts it as
+// `stale` and the parent skips it later. As the links of a child are in the
+// same order as its events, the skipped link is always the one that belonged
+// to the removed event. A nested loop may only take events from a child queue
+// for a long time, so the stale links are also dropped once they outnumber
+// the others, which keeps removal O(1) amortized.
+//
+// A parent queue has a lane per priority. Events of high priority child
+// queues (user input) are processed first, but never more than
+// MULTIQUEUE_HIGH_BURST of them in a row while normal events are waiting.
 
 #include <assert.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <uv.h>
 
 #include "nvim/event/multiqueue.h"
+#include "nvim/macros.h"
 #include "nvim/memory.h"
 #include "nvim/os/time.h"
 
-typedef struct multiqueue_item MultiQueueItem;
-struct multiqueue_item {
-  union {
-    MultiQueue *queue;
-    struct {
-      Event event;
-      MultiQueueItem *parent_item;
-    } item;
-  } data;
-  bool link;  // true: current item is just a link to a node in a child queue
-  QUEUE node;
-};
+/// Slots of a ring when it is first used, a power of two.
+#define MULTIQUEUE_RING_MIN 16
+/// A ring larger than this is freed when it becomes empty, so that a burst of
+/// events does not keep its memory forever.
+#define MULTIQUEUE_RING_KEEP 1024
+/// Maximum number of high priority events processed in a row while normal
+/// priority events are waiting.
+#define MULTIQUEUE_HIGH_BURST 8
+
+typedef struct {
+  Event event;
+  MultiQueue *link;  // not NULL: the item is a link to the next event of a
+                     // child queue, `event` is unused
+} MultiQueueItem;
+
+typedef struct {
+  MultiQueueItem *items;
+  size_t capacity;  // 0 or a power of two
+  size_t head;      // index of the first item
+  size_t count;
+  size_t live;      // items that are not stale links
+} MultiQueueRing;
 
 struct multiqueue {
   MultiQueue *parent;
-  QUEUE headtail;  // circularly-linked
+  MultiQueueRing lanes[MULTIQUEUE_PRIORITIES];  // child queues only use
+                                                // kMultiQueuePriorityNormal
+  MultiQueuePriority priority;  // lane of the links in the parent
+  size_t stale;                 // links in the parent to skip
+  size_t burst;                 // high priority events removed in a row
   PutCallback put_cb;
+  ProcessCallback process_cb;
   void *data;
-  size_t size;
 };
 
 typedef struct {
@@ -98,16 +128,14 @@ MultiQueue *multiqueue_new_child(MultiQueue *parent)
   FUNC_ATTR_NONNULL_ALL
 {
   assert(!parent->parent);  // parent cannot have a parent, more like a "root"
-  parent->size++;
   return multiqueue_new(parent, NULL, NULL);
 }
 
 static MultiQueue *multiqueue_new(MultiQueue *parent, PutCallback put_cb, void *data)
 {
-  MultiQueue *rv = xmalloc(sizeof(MultiQueue));
-  QUEUE_INIT(&rv->headtail);
-  rv->size = 0;
+  MultiQueue *rv = xcalloc(1, sizeof(MultiQueue));
   rv->parent = parent;
+  rv->priority = kMultiQueuePriorityNormal;
   rv->put_cb = put_cb;
   rv->data = data;
   return rv;
@@ -116,17 +144,10 @@ static MultiQueue *multiqueue_new(MultiQueue *parent, PutCallback put_cb, void *
 void multiqueue_free(MultiQueue *this)
 {
   assert(this);
-  QUEUE *q;
-  QUEUE_FOREACH(q, &this->headtail, {
-    MultiQueueItem *item = multiqueue_node_data(q);
-    if (this->parent) {
-      QUEUE_REMOVE(&item->data.item.parent_item->node);
-      xfree(item->data.item.parent_item);
-    }
-    QUEUE_REMOVE(q);
-    xfree(item);
-  })
-
+  multiqueue_unlink(this);
+  for (size_t i = 0; i < MULTIQUEUE_PRIORITIES; i++) {
+    xfree(this->lanes[i].items);
+  }
   xfree(this);
 }
 
@@ -149,13 +170,44 @@ void multiqueue_process_events(MultiQueue *this)
 {
   assert(this);
   while (!multiqueue_empty(this)) {
-    Event event = multiqueue_remove(this);
-    if (event.handler) {
-      event.handler(event.argv);
-    }
+    multiqueue_process_next(this);
   }
 }
 
+/// Removes the next event, if any, and calls its handler.
+void multiqueue_process_next(MultiQueue *this)
+{
+  assert(this);
+  if (multiqueue_empty(this)) {
+    return;
+  }
+  Event event = multiqueue_remove(this);
+  if (!event.handler) {
+    return;
+  }
+  // The handler may change the callback.
+  MultiQueue *root = this->parent ? this->parent : this;
+  ProcessCallback process_cb = root->process_cb;
+  void *data = root->data;
+  if (process_cb) {
+    uint64_t start = os_hrtime();
+    event.handler(event.argv);
+    process_cb(data, event.name, start, os_hrtime());
+  } else {
+    event.handler(event.argv);
+  }
+}
+
+/// Sets the callback for the events of a parent queue and its children that
+/// multiqueue_process_events() or multiqueue_process_next() processes. It gets
+/// the data of the queue.
+void multiqueue_set_process_cb(MultiQueue *this, ProcessCallback process_cb)
+  FUNC_ATTR_NONNULL_ARG(1)
+{
+  assert(!this->parent);
+  this->process_cb = process_cb;
+}
+
 /// Removes all events without processing them.
 void multiqueue_purge_events(MultiQueue *this)
 {
@@ -168,86 +220,172 @@ void multiqueue_purge_events(MultiQueue *this)
 bool multiqueue_empty(MultiQueue *this)
 {
   assert(this);
-  return QUEUE_EMPTY(&this->headtail);
+  return multiqueue_size(this) == 0;
 }
 
 void multiqueue_replace_parent(MultiQueue *this, MultiQueue *new_parent)
 {
   assert(multiqueue_empty(this));
+  multiqueue_unlink(this);
   this->parent = new_parent;
 }
 
+/// Sets the lane of the parent queue the events of a child queue go to. High
+/// priority events overtake normal ones, so this is not for events that must
+/// keep their order with other queues, like the requests of a channel.
+///
+/// The queue must be empty.
+void multiqueue_set_priority(MultiQueue *this, MultiQueuePriority priority)
+  FUNC_ATTR_NONNULL_ALL
+{
+  assert(this->parent && multiqueue_empty(this));
+  multiqueue_unlink(this);
+  this->priority = priority;
+}
+
 /// Gets the count of all events currently in the queue.
 size_t multiqueue_size(MultiQueue *this)
 {
-  return this->size;
+  size_t size = 0;
+  for (size_t i = 0; i < MULTIQUEUE_PRIORITIES; i++) {
+    size += this->lanes[i].live;
+  }
+  return size;
 }
 
-/// Gets an Event from an item.
+/// Removes the links of a child queue from its parent.
 ///
-/// @param remove   Remove the node from its queue, and free it.
-static Event multiqueueitem_get_event(MultiQueueItem *item, bool remove)
+/// Only needed when the queue is detached from its parent: while the queue
+/// has events, they are linked in the parent, the remaining links are stale.
+static void multiqueue_unlink(MultiQueue *this)
 {
-  assert(item != NULL);
-  Event ev;
-  if (item->link) {
-    // get the next node in the linked queue
-    MultiQueue *linked = item->data.queue;
-    assert(!multiqueue_empty(linked));
-    MultiQueueItem *child =
-      multiqueue_node_data(QUEUE_HEAD(&linked->headtail));
-    ev = child->data.item.event;
-    // remove the child node
-    if (remove) {
-      QUEUE_REMOVE(&child->node);
-      xfree(child);
+  if (!this->parent) {
+    return;
+  }
+  MultiQueueRing *ring = &this->parent->lanes[this->priority];
+  size_t mask = ring->capacity - 1;
+  size_t kept = 0;
+  for (size_t i = 0; i < ring->count; i++) {
+    MultiQueueItem *item = &ring->items[(ring->head + i) & mask];
+    if (item->link != this) {
+      ring->items[(ring->head + kept++) & mask] = *item;
     }
-  } else {
-    // remove the corresponding link node in the parent queue
-    if (remove && item->data.item.parent_item) {
-      QUEUE_REMOVE(&item->data.item.parent_item->node);
-      xfree(item->data.item.parent_item);
-      item->data.item.parent_item = NULL;
+  }
+  size_t removed = ring->count - kept;
+  assert(removed == multiqueue_size(this) + this->stale);
+  ring->live -= removed - this->stale;
+  ring->count = kept;
+  this->stale = 0;
+}
+
+/// Removes the stale links from a lane of a parent queue. The stale links of a
+/// child queue are always its oldest ones.
+static void ring_drop_stale(MultiQueueRing *ring)
+{
+  size_t mask = ring->capacity - 1;
+  size_t kept = 0;
+  for (size_t i = 0; i < ring->count; i++) {
+    MultiQueueItem *item = &ring->items[(ring->head + i) & mask];
+    if (item->link && item->link->stale) {
+      item->link->stale--;
+    } else {
+      ring->items[(ring->head + kept++) & mask] = *item;
+    }
+  }
+  assert(kept == ring->live);
+  ring->count = kept;
+  if (!ring->count) {
+    ring->head = 0;
+  }
+}
+
+static void ring_push(MultiQueueRing *ring, MultiQueueItem item)
+{
+  if (ring->count == ring->capacity) {
+    size_t capacity = MAX(ring->capacity * 2, MULTIQUEUE_RING_MIN);
+    MultiQueueItem *items = xmalloc(capacity * sizeof(*items));
+    if (ring->count) {
+      // Unwrap the items, the first ones may be at the end of the array.
+      size_t first = MIN(ring->count, ring->capacity - ring->head);
+      memcpy(items, ring->items + ring->head, first * sizeof(*items));
+      memcpy(items + first, ring->items, (ring->count - first) * sizeof(*items));
+    }
+    xfree(ring->items);
+    ring->items = items;
+    ring->capacity = capacity;
+    ring->head = 0;
+  }
+  ring->items[(ring->head + ring->count) & (ring->capacity - 1)] = item;
+  ring->count++;
+  ring->live++;
+}
+
+static MultiQueueItem ring_shift(MultiQueueRing *ring)
+{
+  assert(ring->count);
+  MultiQueueItem item = ring->items[ring->head];
+  ring->head = (ring->head + 1) & (ring->capacity - 1);
+  ring->count--;
+  if (!ring->count) {
+    ring->head = 0;
+    if (ring->capacity > MULTIQUEUE_RING_KEEP) {
+      XFREE_CLEAR(ring->items);
+      ring->capacity = 0;
     }
-    ev = item->data.item.event;
   }
-  return ev;
+  return item;
+}
+
+/// Gets the lane to remove the next event from.
+static MultiQueueRing *multiqueue_next_lane(MultiQueue *this)
+{
+  MultiQueueRing *high = &this->lanes[kMultiQueuePriorityHigh];
+  MultiQueueRing *normal = &this->lanes[kMultiQueuePriorityNormal];
+  if (high->live && (!normal->live || this->burst < MULTIQUEUE_HIGH_BURST)) {
+    this->burst = normal->live ? this->burst + 1 : 0;
+    return high;
+  }
+  this->burst = 0;
+  return normal;
 }
 
 static Event multiqueue_remove(MultiQueue *this)
 {
   assert(!multiqueue_empty(this));
-  QUEUE *h = QUEUE_HEAD(&this->headtail);
-  QUEUE_REMOVE(h);
-  MultiQueueItem *item = multiqueue_node_data(h);
-  assert(!item->link || !this->parent);  // Only a parent queue has link-nodes
-  Event ev = multiqueueitem_get_event(item, true);
-  this->size--;
-  xfree(item);
-  return ev;
+  MultiQueueRing *ring = multiqueue_next_lane(this);
+  MultiQueueItem item;
+  while ((item = ring_shift(ring)).link && item.link->stale) {
+    // The event was already removed from the child queue.
+    assert(!this->parent);  // Only a parent queue has links
+    item.link->stale--;
+  }
+  ring->live--;
+  if (item.link) {
+    // remove the next event of the linked queue
+    MultiQueueRing *linked = &item.link->lanes[kMultiQueuePriorityNormal];
+    item = ring_shift(linked);
+    linked->live--;
+  } else if (this->parent) {
+    // the link in the parent queue is now stale
+    MultiQueueRing *links = &this->parent->lanes[this->priority];
+    links->live--;
+    this->stale++;
+    if (links->count - links->live > MAX(links->live, MULTIQUEUE_RING_MIN)) {
+      ring_drop_stale(links);
+    }
+  }
+  return item.event;
 }
 
 static void multiqueue_push(MultiQueue *this, Event event)
 {
-  MultiQueueItem *item = xmalloc(sizeof(MultiQueueItem));
-  item->link = false;
-  item->data.item.event = event;
-  item->data.item.parent_item = NULL;
-  QUEUE_INSERT_TAIL(&this->headtail, &item->node);
+  ring_push(&this->lanes[kMultiQueuePriorityNormal],
+            (MultiQueueItem) { .event = event, .link = NULL });
   if (this->parent) {
-    // push link node to the parent queue
-    item->data.item.parent_item = xmalloc(sizeof(MultiQueueItem));
-    item->data.item.parent_item->link = true;
-    item->data.item.parent_item->data.queue = this;
-    QUEUE_INSERT_TAIL(&this->parent->headtail,
-                      &item->data.item.parent_item->node);
+    // push link to the parent queue
+    ring_push(&this->parent->lanes[this->priority],
+              (MultiQueueItem) { .link = this });
   }
-  this->size++;
-}
-
-static MultiQueueItem *multiqueue_node_data(QUEUE *q)
-{
-  return QUEUE_DATA(q, MultiQueueItem, node);
 }
 
 /// Multicasts a one-shot event to multiple queues.
@@ -264,7 +402,9 @@ Event event_create_oneshot(Event ev, int num)
   data->event = ev;
   data->fired = false;
   data->refcount = num;
-  return event_create(multiqueue_oneshot_event, 1, data);
+  Event rv = event_create(multiqueue_oneshot_event, 1, data);
+  rv.name = ev.name;
+  return rv;
 }
 static void multiqueue_oneshot_event(void **argv)
 {
@@ -1,6 +1,7 @@
 #ifndef NVIM_EVENT_MULTIQUEUE_H
 #define NVIM_EVENT_MULTIQUEUE_H
 
+#include <stdint.h>
 #include <uv.h>
 
 #include "nvim/event/defs.h"
@@ -8,6 +9,16 @@
 
 typedef struct multiqueue MultiQueue;
 typedef void (*PutCallback)(MultiQueue *multiq, void *data);
+/// Called after multiqueue_process_next() processed an event, with the
+/// os_hrtime() before and after the handler.
+typedef void (*ProcessCallback)(void *data, const char *name, uint64_t start, uint64_t end);
+
+/// Lanes of a parent queue, see multiqueue_set_priority().
+typedef enum {
+  kMultiQueuePriorityHigh = 0,    ///< User input.
+  kMultiQueuePriorityNormal = 1,  ///< Everything else.
+} MultiQueuePriority;
+#define MULTIQUEUE_PRIORITIES 2
 
 #define multiqueue_put(q, h, ...) \
   multiqueue_put_event(q, event_create(h, __VA_ARGS__));
@@ -4,6 +4,10 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <uv.h>
+#ifndef WIN32
+# include <errno.h>
+# include <sys/wait.h>
+#endif
 
 #include "nvim/event/libuv_process.h"
 #include "nvim/event/loop.h"
@@ -83,7 +87,9 @@ int process_spawn(Process *proc, bool in, bool out, bool err)
     }
 
     if (proc->type == kProcessTypeUv) {
-      uv_close((uv_handle_t *)&(((LibuvProcess *)proc)->uv), NULL);
+      if (!((LibuvProcess *)proc)->spawned) {
+        uv_close((uv_handle_t *)&(((LibuvProcess *)proc)->uv), NULL);
+      }
     } else {
       process_close(proc);
     }
@@ -143,6 +149,43 @@ void process_teardown(Loop *loop) FUNC_ATTR_NONNULL_ALL
   pty_process_teardown(loop);
 }
 
+#ifndef WIN32
+/// Starts reaping the children that libuv does not know about: PTY processes
+/// and processes started by posix_spawn(), see libuv_process_spawn(). Must be
+/// called before the child is created, so that its exit is not missed.
+void process_watch_children(Loop *loop)
+  FUNC_ATTR_NONNULL_ALL
+{
+  uv_signal_start(&loop->children_watcher, chld_handler, SIGCHLD);
+}
+
+static void chld_handler(uv_signal_t *handle, int signum)
+{
+  int stat = 0;
+  int pid;
+
+  Loop *loop = handle->loop->data;
+
+  kl_iter(WatcherPtr, loop->children, current) {
+    Process *proc = (*current)->data;
+    do {
+      pid = waitpid(proc->pid, &stat, WNOHANG);
+    } while (pid < 0 && errno == EINTR);
+
+    if (pid <= 0) {
+      continue;
+    }
+
+    if (WIFEXITED(stat)) {
+      proc->status = WEXITSTATUS(stat);
+    } else if (WIFSIGNALED(stat)) {
+      proc->status = 128 + WTERMSIG(stat);
+    }
+    proc->internal_exit_cb(proc);
+  }
+}
+#endif
+
 void process_close_streams(Process *proc) FUNC_ATTR_NONNULL_ALL
 {
   stream_may_close(&proc->in);
@@ -317,7 +360,7 @@ static void process_close(Process *proc)
   proc->closed = true;
 
   if (proc->detach) {
-    if (proc->type == kProcessTypeUv) {
+    if (proc->type == kProcessTypeUv && !((LibuvProcess *)proc)->spawned) {
       uv_unref((uv_handle_t *)&(((LibuvProcess *)proc)->uv));
     }
   }
@@ -10,11 +10,20 @@
 #include "nvim/ascii.h"
 #include "nvim/event/loop.h"
 #include "nvim/event/rstream.h"
+#include "nvim/event/shm.h"
 #include "nvim/log.h"
 #include "nvim/memory.h"
 #include "nvim/main.h"
+#include "nvim/os/time.h"
 #include "nvim/vim.h"
 
+/// Largest capacity the buffer of a stream grows to, see rstream_adapt().
+#define RSTREAM_MAX_BUFSIZE (4 * 1024 * 1024)
+/// The buffer grows when it fills up faster than this (nanoseconds).
+#define RSTREAM_GROW_TIME 100000000
+/// The buffer shrinks back when it was not full for this long (nanoseconds).
+#define RSTREAM_SHRINK_TIME 1000000000
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "event/rstream.c.generated.h"
 #endif
@@ -40,6 +49,7 @@ void rstream_init(Stream *stream, size_t bufsize)
   stream->buffer->data = stream;
   stream->buffer->full_cb = on_rbuffer_full;
   stream->buffer->nonfull_cb = on_rbuffer_nonfull;
+  stream->read_bufsize = rbuffer_capacity(stream->buffer);
 }
 
 
@@ -53,6 +63,9 @@ void rstream_start(Stream *stream, stream_read_cb cb, void *data)
   stream->cb_data = data;
   if (stream->uvstream) {
     uv_read_start(stream->uvstream, alloc_cb, read_cb);
+    if (stream->shm) {
+      shm_read_start(stream->shm);
+    }
   } else {
     uv_idle_start(&stream->uv.idle, fread_idle_cb);
   }
@@ -64,7 +77,10 @@ void rstream_start(Stream *stream, stream_read_cb cb, void *data)
 void rstream_stop(Stream *stream)
   FUNC_ATTR_NONNULL_ALL
 {
-  if (stream->uvstream) {
+  if (stream->shm) {
+    // Keep reading the socket, for wakeups and EOF.
+    shm_read_stop(stream->shm);
+  } else if (stream->uvstream) {
     uv_read_stop(stream->uvstream);
   } else {
     uv_idle_stop(&stream->uv.idle);
@@ -73,7 +89,17 @@ void rstream_stop(Stream *stream)
 
 static void on_rbuffer_full(RBuffer *buf, void *data)
 {
-  rstream_stop(data);
+  Stream *stream = data;
+  uint64_t now = os_hrtime();
+  stream->read_full = now;
+  // A fast producer keeps reading into a larger buffer, instead of stopping
+  // and starting again each time the consumer catches up.
+  if (!stream->shm && rbuffer_capacity(buf) < RSTREAM_MAX_BUFSIZE
+      && now - stream->read_start < RSTREAM_GROW_TIME) {
+    stream->read_grow = true;
+    return;
+  }
+  rstream_stop(stream);
 }
 
 static void on_rbuffer_nonfull(RBuffer *buf, void *data)
@@ -89,12 +115,66 @@ static void on_rbuffer_nonfull(RBuffer *buf, void *data)
 static void alloc_cb(uv_handle_t *handle, size_t suggested, uv_buf_t *buf)
 {
   Stream *stream = handle->data;
+  if (stream->shm) {
+    // The socket only carries wakeups, which are discarded.
+    static char wakeups[64];
+    buf->base = wakeups;
+    buf->len = sizeof(wakeups);
+    return;
+  }
+  rstream_adapt(stream);
   // `uv_buf_t.len` happens to have different size on Windows.
   size_t write_count;
   buf->base = rbuffer_write_ptr(stream->buffer, &write_count);
   buf->len = UV_BUF_LEN(write_count);
 }
 
+/// Adapts the capacity of the buffer to the throughput, before a read.
+///
+/// The buffer doubles when it filled up in less than RSTREAM_GROW_TIME, up
+/// to RSTREAM_MAX_BUFSIZE. Once it was not full for RSTREAM_SHRINK_TIME, it
+/// goes back to its initial capacity the next time it is empty.
+static void rstream_adapt(Stream *stream)
+{
+  RBuffer *buf = stream->buffer;
+  size_t capacity = rbuffer_capacity(buf);
+  if (stream->read_grow) {
+    stream->read_grow = false;
+    rstream_resize(stream, MIN(capacity * 2, RSTREAM_MAX_BUFSIZE));
+    stream->read_start = os_hrtime();
+  } else if (!rbuffer_size(buf)) {
+    uint64_t now = os_hrtime();
+    if (capacity > stream->read_bufsize && now - stream->read_full > RSTREAM_SHRINK_TIME) {
+      rstream_resize(stream, stream->read_bufsize);
+    }
+    stream->read_start = now;
+  }
+}
+
+static void rstream_resize(Stream *stream, size_t capacity)
+{
+  rbuffer_resize(stream->buffer, capacity);
+  // All data left in the buffer belongs to queued read events.
+  if (stream->read_end) {
+    stream->read_end = stream->buffer->write_ptr;
+  }
+}
+
+/// Takes the memory holding the first `count` bytes of the buffer of a
+/// stream, see rbuffer_take(). Lets a read callback keep a large chunk of
+/// data without copying it.
+///
+/// @return The memory, or NULL if the data is not at its beginning.
+char *rstream_take(Stream *stream, size_t count)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT
+{
+  char *rv = rbuffer_take(stream->buffer, count);
+  if (rv && stream->read_end) {
+    stream->read_end = stream->buffer->write_ptr;
+  }
+  return rv;
+}
+
 // Callback invoked by libuv after it copies the data into the buffer provided
 // by `alloc_cb`. This is also called on EOF or when `alloc_cb` returns a
 // 0-length buffer.
@@ -111,27 +191,36 @@ static void read_cb(uv_stream_t *uvstream, ssize_t cnt, const uv_buf_t *buf)
     // won't be called)
     if (cnt == UV_ENOBUFS || cnt == 0) {
       return;
+    } else if (stream->shm) {
+      // EOF is passed on once the data in the ring was read.
+      uv_read_stop(uvstream);
+      shm_wake(stream->shm, true);
     } else if (cnt == UV_EOF && uvstream->type == UV_TTY) {
       // The TTY driver might signal EOF without closing the stream
-      invoke_read_cb(stream, 0, true);
+      invoke_read_cb(stream, NULL, 0, true);
     } else {
       DLOG("closing Stream (%p): %s (%s)", (void *)stream,
            uv_err_name((int)cnt), os_strerror((int)cnt));
       // Read error or EOF, either way stop the stream and invoke the callback
       // with eof == true
       uv_read_stop(uvstream);
-      invoke_read_cb(stream, 0, true);
+      invoke_read_cb(stream, NULL, 0, true);
     }
     return;
   }
 
+  if (stream->shm) {
+    shm_wake(stream->shm, false);
+    return;
+  }
+
   // at this point we're sure that cnt is positive, no error occurred
   size_t nread = (size_t)cnt;
   stream->num_bytes += nread;
   // Data was already written, so all we need is to update 'wpos' to reflect
   // the space actually used in the buffer.
   rbuffer_produced(stream->buffer, nread);
-  invoke_read_cb(stream, nread, false);
+  invoke_read_cb(stream, buf->base, nread, false);
 }
 
 // Called by the by the 'idle' handle to emulate a reading event
@@ -144,6 +233,7 @@ static void fread_idle_cb(uv_idle_t *handle)
   uv_fs_t req;
   Stream *stream = handle->data;
 
+  rstream_adapt(stream);
   // `uv_buf_t.len` happens to have different size on Windows.
   size_t write_count;
   stream->uvbuf.base = rbuffer_write_ptr(stream->buffer, &write_count);
@@ -171,7 +261,7 @@ static void fread_idle_cb(uv_idle_t *handle)
 
   if (req.result <= 0) {
     uv_idle_stop(&stream->uv.idle);
-    invoke_read_cb(stream, 0, true);
+    invoke_read_cb(stream, NULL, 0, true);
     return;
   }
 
@@ -179,14 +269,31 @@ static void fread_idle_cb(uv_idle_t *handle)
   size_t nread = (size_t)req.result;
   rbuffer_produced(stream->buffer, nread);
   stream->fpos += nread;
-  invoke_read_cb(stream, nread, false);
+  invoke_read_cb(stream, stream->uvbuf.base, nread, false);
+}
+
+/// Passes `count` bytes to the read callback, which were written to the
+/// buffer at `data` by other means than a libuv read, see shm.c.
+void rstream_produced(Stream *stream, char *data, size_t count, bool eof)
+  FUNC_ATTR_NONNULL_ARG(1)
+{
+  if (count) {
+    stream->num_bytes += count;
+    rbuffer_produced(stream->buffer, count);
+  }
+  invoke_read_cb(stream, data, count, eof);
 }
 
 static void read_event(void **argv)
 {
   Stream *stream = argv[0];
+  // Merged reads always belong to the first queued event.
+  size_t count = (uintptr_t)argv[1] + stream->read_merged;
+  stream->read_merged = 0;
+  if (!--stream->read_queued) {
+    stream->read_end = NULL;
+  }
   if (stream->read_cb) {
-    size_t count = (uintptr_t)argv[1];
     bool eof = (uintptr_t)argv[2];
     stream->did_eof = eof;
     stream->read_cb(stream, stream->buffer, count, stream->cb_data, eof);
@@ -197,8 +304,21 @@ static void read_event(void **argv)
   }
 }
 
-static void invoke_read_cb(Stream *stream, size_t count, bool eof)
+/// Passes `count` bytes read to `data` in the buffer to the read callback.
+///
+/// Data that directly follows the data of the only queued read event is
+/// passed on by that event. A burst of reads thus reaches the callback as one
+/// large chunk, instead of one event per read.
+static void invoke_read_cb(Stream *stream, char *data, size_t count, bool eof)
 {
+  if (!eof && stream->read_queued == 1 && data == stream->read_end) {
+    stream->read_merged += count;
+    stream->read_end = data + count;
+    return;
+  }
+  stream->read_end = eof ? NULL : data + count;
+  stream->read_queued++;
+
   // Don't let the stream be closed before the event is processed.
   stream->pending_reqs++;
 
@@ -0,0 +1,423 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// Shared memory transport for streams of local sockets.
+//
+// Both sides map the same file, which holds a ring for each direction. The
+// data is copied straight from one process to the other, the socket is only
+// written to when the other side waits for it, see ShmRing. The socket also
+// signals EOF when the peer goes away.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <uv.h>
+#ifndef WIN32
+# include <errno.h>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#include "nvim/event/rstream.h"
+#include "nvim/event/shm.h"
+#include "nvim/event/stream.h"
+#include "nvim/event/wstream.h"
+#include "nvim/log.h"
+#include "nvim/macros.h"
+#include "nvim/memory.h"
+#include "nvim/os/os.h"
+
+#define SHM_MAGIC 0x6e766d73  // "nvms"
+#define SHM_VERSION 1
+#define SHM_RING_MIN 4096
+#define SHM_RING_MAX (64 * 1024 * 1024)
+
+/// Start of the mapping, followed by the rings and their data.
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t ring_size;
+  char pad[52];
+} ShmHeader;
+
+// The counters and flags are shared with another process.
+#ifdef _MSC_VER
+# define SHM_LOAD(p) (*(volatile uint32_t *)(p))
+# define SHM_STORE(p, v) ((void)InterlockedExchange((volatile LONG *)(p), (LONG)(v)))
+# define SHM_XCHG(p, v) ((uint32_t)InterlockedExchange((volatile LONG *)(p), (LONG)(v)))
+#else
+# define SHM_LOAD(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define SHM_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+# define SHM_XCHG(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#endif
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "event/shm.c.generated.h"
+#endif
+
+static size_t shm_map_size(uint32_t ring_size)
+{
+  return sizeof(ShmHeader) + 2 * sizeof(ShmRing) + 2 * (size_t)ring_size;
+}
+
+/// Creates the shared memory of a transport, for the client side.
+///
+/// @param path File to create, pass it to the server and remove it once the
+///        server has mapped it.
+/// @param ring_size Size of each ring, a power of two.
+/// @param[out] error Set on failure.
+/// @return The transport, or NULL on failure.
+ShmTransport *shm_create(const char *path, uint32_t ring_size, const char **error)
+  FUNC_ATTR_NONNULL_ALL
+{
+  assert(ring_size >= SHM_RING_MIN && ring_size <= SHM_RING_MAX
+         && !(ring_size & (ring_size - 1)));
+#ifdef WIN32
+  *error = "shared memory is not supported on this platform";
+  return NULL;
+#else
+  size_t map_size = shm_map_size(ring_size);
+  int fd = os_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    *error = os_strerror(fd);
+    return NULL;
+  }
+  char *map = MAP_FAILED;
+  if (ftruncate(fd, (off_t)map_size) == 0) {
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (map == MAP_FAILED) {
+    *error = strerror(errno);
+    os_close(fd);
+    os_remove(path);
+    return NULL;
+  }
+  os_close(fd);
+
+  // The file starts out zeroed, which are empty rings.
+  ShmHeader *header = (ShmHeader *)map;
+  header->ring_size = ring_size;
+  header->version = SHM_VERSION;
+  header->magic = SHM_MAGIC;
+  return shm_new(map, map_size, ring_size, false);
+#endif
+}
+
+/// Maps the shared memory created by a client with shm_create().
+///
+/// @param[out] error Set on failure.
+/// @return The transport, or NULL on failure.
+ShmTransport *shm_attach(const char *path, const char **error)
+  FUNC_ATTR_NONNULL_ALL
+{
+#ifdef WIN32
+  *error = "shared memory is not supported on this platform";
+  return NULL;
+#else
+  int fd = os_open(path, O_RDWR, 0);
+  if (fd < 0) {
+    *error = os_strerror(fd);
+    return NULL;
+  }
+  ShmHeader header;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)
+      || read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)
+      || header.magic != SHM_MAGIC || header.version != SHM_VERSION
+      || header.ring_size < SHM_RING_MIN || header.ring_size > SHM_RING_MAX
+      || (header.ring_size & (header.ring_size - 1))
+      || (uintmax_t)st.st_size != shm_map_size(header.ring_size)) {
+    *error = "invalid shared memory file";
+    os_close(fd);
+    return NULL;
+  }
+  size_t map_size = shm_map_size(header.ring_size);
+  char *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  os_close(fd);
+  if (map == MAP_FAILED) {
+    *error = strerror(errno);
+    return NULL;
+  }
+  return shm_new(map, map_size, header.ring_size, true);
+#endif
+}
+
+static ShmTransport *shm_new(char *map, size_t map_size, uint32_t ring_size, bool server)
+{
+  ShmTransport *shm = xcalloc(1, sizeof(ShmTransport));
+  shm->map = map;
+  shm->map_size = map_size;
+  shm->size = ring_size;
+  // The first ring carries the output of the client, the second one the
+  // output of the server.
+  ShmRing *rings = (ShmRing *)(map + sizeof(ShmHeader));
+  char *data = map + sizeof(ShmHeader) + 2 * sizeof(ShmRing);
+  size_t in = server ? 0 : 1;
+  shm->in = &rings[in];
+  shm->out = &rings[1 - in];
+  shm->in_data = data + in * ring_size;
+  shm->out_data = data + (1 - in) * ring_size;
+  kv_init(shm->pending);
+  return shm;
+}
+
+/// Frees a transport which was not started or whose handle was closed.
+void shm_free(ShmTransport *shm)
+  FUNC_ATTR_NONNULL_ALL
+{
+  for (size_t i = 0; i < kv_size(shm->pending); i++) {
+    wstream_release_wbuffer(kv_A(shm->pending, i));
+  }
+  kv_destroy(shm->pending);
+#ifndef WIN32
+  munmap(shm->map, shm->map_size);
+#endif
+  xfree(shm);
+}
+
+/// Makes `stream` read from and write to the shared memory.
+///
+/// The peer must switch at the same point of the stream: what was written to
+/// the socket before must have been read.
+void shm_start(ShmTransport *shm, Stream *stream)
+  FUNC_ATTR_NONNULL_ALL
+{
+  assert(!stream->shm && stream->uvstream);
+  shm->stream = stream;
+  shm->reading = stream->read_cb != NULL;
+  uv_idle_init(stream->uvstream->loop, &shm->idle);
+  shm->idle.data = shm;
+  stream->shm = shm;
+  // The peer may have written already.
+  uv_idle_start(&shm->idle, shm_idle_cb);
+}
+
+/// Closes the transport of a stream whose handle is closed.
+void shm_close(ShmTransport *shm)
+  FUNC_ATTR_NONNULL_ALL
+{
+  if (kv_size(shm->pending)) {
+    WLOG("closed Stream (%p) with %zu unwritten buffers",
+         (void *)shm->stream, kv_size(shm->pending));
+  }
+  shm->stream->shm = NULL;
+  uv_close((uv_handle_t *)&shm->idle, shm_close_cb);
+}
+
+static void shm_close_cb(uv_handle_t *handle)
+{
+  shm_free(handle->data);
+}
+
+void shm_read_start(ShmTransport *shm)
+  FUNC_ATTR_NONNULL_ALL
+{
+  shm->reading = true;
+  uv_idle_start(&shm->idle, shm_idle_cb);
+}
+
+void shm_read_stop(ShmTransport *shm)
+  FUNC_ATTR_NONNULL_ALL
+{
+  shm->reading = false;
+}
+
+/// Called when the socket was written to by the peer, or reached EOF.
+void shm_wake(ShmTransport *shm, bool eof)
+  FUNC_ATTR_NONNULL_ALL
+{
+  shm->eof |= eof;
+  uv_idle_start(&shm->idle, shm_idle_cb);
+}
+
+/// Writes `buffer` to the peer, see wstream_write().
+///
+/// What does not fit into the ring is kept, and written once the peer has
+/// made room.
+bool shm_write(ShmTransport *shm, WBuffer *buffer)
+  FUNC_ATTR_NONNULL_ALL
+{
+  size_t written = 0;
+  if (!kv_size(shm->pending)) {
+    written = shm_ring_write(shm, buffer->data, buffer->size);
+  }
+  if (shm->broken) {
+    wstream_release_wbuffer(buffer);
+    return false;
+  } else if (written == buffer->size) {
+    wstream_release_wbuffer(buffer);
+    return true;
+  }
+
+  if (!kv_size(shm->pending)) {
+    shm->pending_off = written;
+  }
+  kv_push(shm->pending, buffer);
+  shm->stream->curmem += buffer->size;
+  uv_idle_start(&shm->idle, shm_idle_cb);
+  return true;
+}
+
+static void shm_idle_cb(uv_idle_t *handle)
+{
+  ShmTransport *shm = handle->data;
+  Stream *stream = shm->stream;
+  if (stream->closed) {
+    uv_idle_stop(handle);
+    return;
+  }
+
+  shm_flush(shm);
+  shm_drain(shm);
+  if (shm->reading && !shm->did_eof
+      && (shm->broken || (shm->eof && !shm_readable(shm)))) {
+    shm->did_eof = true;
+    rstream_produced(stream, NULL, 0, true);
+  }
+
+  if (shm_can_sleep(shm)) {
+    uv_idle_stop(handle);
+  }
+}
+
+/// Tells the peer that it should wait for the socket, and checks once more
+/// if there is something to do.
+static bool shm_can_sleep(ShmTransport *shm)
+{
+  if (shm->broken) {
+    return true;
+  }
+  if (shm->reading && !shm->eof) {
+    SHM_STORE(&shm->in->reader_sleeping, 1);
+    if (shm_readable(shm)) {
+      SHM_STORE(&shm->in->reader_sleeping, 0);
+      return false;
+    }
+  }
+  if (kv_size(shm->pending)) {
+    SHM_STORE(&shm->out->writer_sleeping, 1);
+    if (shm->out_head - SHM_LOAD(&shm->out->tail) != shm->size) {
+      SHM_STORE(&shm->out->writer_sleeping, 0);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool shm_readable(ShmTransport *shm)
+{
+  return SHM_LOAD(&shm->in->head) != shm->in_tail;
+}
+
+/// Copies data from the peer to the read buffer of the stream.
+static void shm_drain(ShmTransport *shm)
+{
+  Stream *stream = shm->stream;
+  while (shm->reading && !shm->broken) {
+    uint32_t avail = SHM_LOAD(&shm->in->head) - shm->in_tail;
+    if (avail > shm->size) {
+      shm_corrupt(shm);
+      return;
+    }
+    size_t count;
+    char *ptr = rbuffer_write_ptr(stream->buffer, &count);
+    if (!avail || !count) {
+      return;
+    }
+    size_t n = MIN(avail, count);
+    size_t pos = shm->in_tail & (shm->size - 1);
+    size_t first = MIN(n, shm->size - pos);
+    memcpy(ptr, shm->in_data + pos, first);
+    memcpy(ptr + first, shm->in_data, n - first);
+    shm->in_tail += (uint32_t)n;
+    SHM_STORE(&shm->in->tail, shm->in_tail);
+    if (SHM_XCHG(&shm->in->writer_sleeping, 0)) {
+      shm_doorbell(shm);
+    }
+    // May stop reading, when the buffer is full.
+    rstream_produced(stream, ptr, n, false);
+  }
+}
+
+/// Writes pending buffers, as far as there is room.
+static void shm_flush(ShmTransport *shm)
+{
+  Stream *stream = shm->stream;
+  bool written = false;
+  while (kv_size(shm->pending) && !shm->broken) {
+    WBuffer *buffer = kv_A(shm->pending, 0);
+    shm->pending_off += shm_ring_write(shm, buffer->data + shm->pending_off,
+                                       buffer->size - shm->pending_off);
+    if (shm->pending_off < buffer->size) {
+      break;
+    }
+    kv_size(shm->pending)--;
+    memmove(&kv_A(shm->pending, 0), &kv_A(shm->pending, 1),
+            kv_size(shm->pending) * sizeof(WBuffer *));
+    shm->pending_off = 0;
+    stream->curmem -= buffer->size;
+    wstream_release_wbuffer(buffer);
+    written = true;
+  }
+  if (written && stream->write_cb) {
+    stream->write_cb(stream, stream->cb_data, 0);
+  }
+}
+
+/// Copies as much of `data` to the ring as fits.
+///
+/// @return Number of bytes copied.
+static size_t shm_ring_write(ShmTransport *shm, const char *data, size_t size)
+{
+  uint32_t used = shm->out_head - SHM_LOAD(&shm->out->tail);
+  if (used > shm->size) {
+    shm_corrupt(shm);
+    return 0;
+  }
+  size_t n = MIN(size, shm->size - used);
+  if (!n) {
+    return 0;
+  }
+  size_t pos = shm->out_head & (shm->size - 1);
+  size_t first = MIN(n, shm->size - pos);
+  memcpy(shm->out_data + pos, data, first);
+  memcpy(shm->out_data, data + first, n - first);
+  shm->out_head += (uint32_t)n;
+  SHM_STORE(&shm->out->head, shm->out_head);
+  if (SHM_XCHG(&shm->out->reader_sleeping, 0)) {
+    shm_doorbell(shm);
+  }
+  return n;
+}
+
+/// The peer wrote counters that cannot be right, the stream gets EOF and
+/// writes fail.
+static void shm_corrupt(ShmTransport *shm)
+{
+  ELOG("shared memory of Stream (%p) is corrupt", (void *)shm->stream);
+  shm->broken = true;
+  uv_idle_start(&shm->idle, shm_idle_cb);
+}
+
+/// Wakes up the peer, which waits for the socket.
+static void shm_doorbell(ShmTransport *shm)
+{
+  static char byte = 0;
+  Stream *stream = shm->stream;
+  if (stream->closed) {
+    return;
+  }
+  uv_write_t *req = xmalloc(sizeof(uv_write_t));
+  uv_buf_t buf = uv_buf_init(&byte, 1);
+  if (uv_write(req, stream->uvstream, &buf, 1, shm_doorbell_cb)) {
+    xfree(req);
+  }
+}
+
+static void shm_doorbell_cb(uv_write_t *req, int status)
+{
+  xfree(req);
+}
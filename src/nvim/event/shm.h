@@ -0,0 +1,55 @@
+#ifndef NVIM_EVENT_SHM_H
+#define NVIM_EVENT_SHM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <uv.h>
+
+#include "nvim/event/stream.h"
+#include "nvim/event/wstream.h"
+#include "nvim/lib/kvec.h"
+
+/// Default size of each ring, must be a power of two.
+#define SHM_RING_SIZE (1024 * 1024)
+
+/// One direction of a shared memory transport, placed in the mapping.
+///
+/// `head` and `tail` count the bytes written and read, they wrap around at
+/// 2^32 and the position in the ring is the count modulo the ring size. A
+/// side sets its `*_sleeping` flag before it waits for the socket, the other
+/// side then writes a byte to the socket to wake it up.
+typedef struct {
+  uint32_t head;             ///< Advanced by the writer.
+  uint32_t tail;             ///< Advanced by the reader.
+  uint32_t reader_sleeping;  ///< Reader waits for data.
+  uint32_t writer_sleeping;  ///< Writer waits for room.
+  char pad[48];              ///< Keeps the rings on separate cache lines.
+} ShmRing;
+
+/// Pair of rings shared by both sides of a local socket channel.
+///
+/// Messages go through the rings, the socket only carries wakeups and
+/// detects when the peer goes away.
+struct shm_transport {
+  Stream *stream;      ///< Stream using the transport, once started.
+  char *map;
+  size_t map_size;
+  uint32_t size;       ///< Size of each ring.
+  ShmRing *in, *out;
+  char *in_data, *out_data;
+  uint32_t in_tail;    ///< Own copies of the counters the peer must not
+  uint32_t out_head;   ///< change.
+  uv_idle_t idle;      ///< Copies data while the rings are busy.
+  kvec_t(WBuffer *) pending;  ///< Buffers that did not fit yet.
+  size_t pending_off;  ///< Bytes of the first pending buffer already written.
+  bool reading;        ///< The stream reads, see rstream_start().
+  bool eof;            ///< The socket reached EOF.
+  bool broken;         ///< The peer wrote invalid counters.
+  bool did_eof;        ///< EOF was passed on to the stream.
+};
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "event/shm.h.generated.h"
+#endif
+#endif  // NVIM_EVENT_SHM_H
@@ -6,7 +6,9 @@
 #include <stdio.h>
 #include <uv.h>
 
+#include "nvim/event/shm.h"
 #include "nvim/event/stream.h"
+#include "nvim/lib/kvec.h"
 #include "nvim/log.h"
 #include "nvim/macros.h"
 #include "nvim/rbuffer.h"
@@ -98,6 +100,17 @@ void stream_init(Loop *loop, Stream *stream, int fd, uv_stream_t *uvstream)
   stream->buffer = NULL;
   stream->events = NULL;
   stream->num_bytes = 0;
+  stream->num_writes = 0;
+  kv_init(stream->wqueue);
+  stream->writing = false;
+  stream->read_queued = 0;
+  stream->read_merged = 0;
+  stream->read_end = NULL;
+  stream->read_bufsize = 0;
+  stream->read_start = 0;
+  stream->read_full = 0;
+  stream->read_grow = false;
+  stream->shm = NULL;
 }
 
 void stream_close(Stream *stream, stream_close_cb on_stream_close, void *data)
@@ -131,6 +144,9 @@ void stream_may_close(Stream *stream)
 void stream_close_handle(Stream *stream)
   FUNC_ATTR_NONNULL_ALL
 {
+  if (stream->shm) {
+    shm_close(stream->shm);
+  }
   if (stream->uvstream) {
     if (uv_stream_get_write_queue_size(stream->uvstream) > 0) {
       WLOG("closed Stream (%p) with %zu unwritten bytes",
@@ -149,6 +165,7 @@ static void close_cb(uv_handle_t *handle)
   if (stream->buffer) {
     rbuffer_free(stream->buffer);
   }
+  kv_destroy(stream->wqueue);
   if (stream->close_cb) {
     stream->close_cb(stream, stream->close_cb_data);
   }
@@ -3,12 +3,16 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <uv.h>
 
 #include "nvim/event/loop.h"
+#include "nvim/lib/kvec.h"
 #include "nvim/rbuffer.h"
 
 typedef struct stream Stream;
+typedef struct shm_transport ShmTransport;
+typedef struct wbuffer WBuffer;
 /// Type of function called when the Stream buffer is filled with data
 ///
 /// @param stream The Stream instance
@@ -53,7 +57,20 @@ struct stream {
   size_t maxmem;
   size_t pending_reqs;
   size_t num_bytes;
+  size_t num_writes;  // uv_write() requests, each writes all queued buffers.
+  kvec_t(WBuffer *) wqueue;  // Buffers waiting for the write in flight.
+  bool writing;  // A uv_write() request is in flight.
   MultiQueue *events;
+  // Queued read events, and bytes read since the last one was queued that it
+  // will pass on as well, see invoke_read_cb().
+  size_t read_queued;
+  size_t read_merged;
+  char *read_end;  // End of the data of the last queued read event, or NULL.
+  size_t read_bufsize;  // Initial capacity of the buffer, see rstream_adapt().
+  uint64_t read_start;  // When the buffer started to fill up.
+  uint64_t read_full;   // When the buffer was full the last time.
+  bool read_grow;       // The buffer is full, grow it on the next read.
+  ShmTransport *shm;  // Used instead of the socket, see shm_start().
 };
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
@@ -0,0 +1,139 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// Throttling of output that arrives faster than it can be consumed: after
+// `threshold` bytes the output is skipped, except for its tail, for a while.
+//
+// Used by ":!" (where the UI is the bottleneck) and by job callbacks that opt
+// in with the "throttle" option of jobstart().
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nvim/event/throttle.h"
+#include "nvim/memory.h"
+#include "nvim/os/time.h"
+#include "nvim/vim.h"
+
+#define NS_1_SECOND 1000000000U  // 1 second, in nanoseconds
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "event/throttle.c.generated.h"
+#endif
+
+/// Initializes a throttle.
+///
+/// @param threshold  Bytes that are passed before output is skipped, 0 never
+///                   skips. The last `threshold / 2` skipped bytes are kept.
+void throttle_init(Throttle *throttle, size_t threshold)
+  FUNC_ATTR_NONNULL_ALL
+{
+  *throttle = THROTTLE_INIT;
+  throttle->threshold = threshold;
+}
+
+void throttle_free(Throttle *throttle)
+  FUNC_ATTR_NONNULL_ALL
+{
+  XFREE_CLEAR(throttle->ring);
+  throttle->ring_len = 0;
+}
+
+/// Tracks output received from the producer, and decides whether it should be
+/// skipped. Skipped output is saved in a quasi-ringbuffer, see throttle_end().
+///
+/// Output is passed until `threshold` bytes were received in quick
+/// succession (without a pause of a second). Then it is skipped, and the pulse
+/// callback is invoked with increasing intervals, until 3 seconds passed and
+/// it starts over.
+///
+/// @returns true if the output should be skipped.
+bool throttle_skip(Throttle *throttle, const char *data, size_t size)
+  FUNC_ATTR_NONNULL_ARG(1)
+{
+  if (!throttle->threshold || !size || !throttle_decide(throttle, size)) {
+    return false;
+  }
+  assert(data != NULL);
+  throttle_save(throttle, data, size);
+  return true;
+}
+
+/// Ends the current throttle, the next output is passed again.
+///
+/// @param[out]  data  Set to the tail of the skipped output, valid until the
+///                    next call of throttle_skip() or throttle_free().
+///
+/// @returns length of `data` if the last output was skipped, else 0.
+size_t throttle_end(Throttle *throttle, const char **data)
+  FUNC_ATTR_NONNULL_ALL
+{
+  size_t len = throttle->pulse ? throttle->ring_len : 0;
+  *data = throttle->ring;
+  throttle->started = throttle->received = throttle->pulse = 0;
+  throttle->ring_len = 0;
+  return len;
+}
+
+static bool throttle_decide(Throttle *throttle, size_t size)
+{
+  uint64_t now = os_hrtime();
+  if (!throttle->pulse && now - throttle->last > NS_1_SECOND) {
+    // The consumer keeps up with slow output.
+    throttle->received = 0;
+  }
+  throttle->last = now;
+
+  throttle->received += size;
+  if (throttle->received < throttle->threshold
+      // Pass at least the first chunk of output even if it is big.
+      || (!throttle->started && throttle->received < size + 1000)) {
+    return false;
+  } else if (!throttle->pulse) {
+    throttle->started = now;
+    throttle->ring_len = 0;
+  } else {
+    uint64_t since = now - throttle->started;
+    if (since < (throttle->pulse * 0.1L * NS_1_SECOND)) {
+      return true;
+    }
+    if (since > (3 * NS_1_SECOND)) {
+      throttle->received = throttle->pulse = 0;
+      return false;
+    }
+  }
+
+  throttle->pulse++;
+  if (throttle->pulse_cb) {
+    throttle->pulse_cb(throttle, throttle->pulse);
+  }
+  return true;
+}
+
+/// Keeps the last `threshold / 2` bytes of the skipped output.
+static void throttle_save(Throttle *throttle, const char *data, size_t size)
+{
+  size_t max = throttle->threshold / 2;
+  if (!throttle->ring) {
+    throttle->ring = xmalloc(MAX(max, 1));
+  }
+
+  // This is basically a ring-buffer...
+  if (size >= max) {
+    memcpy(throttle->ring, data + size - max, max);
+    throttle->ring_len = max;
+  } else {
+    // Length of the old data that can be kept.
+    size_t keep_len = MIN(throttle->ring_len, max - size);
+    size_t keep_start = throttle->ring_len - keep_len;
+    // Shift the kept part of the old data to the start.
+    if (keep_start) {
+      memmove(throttle->ring, throttle->ring + keep_start, keep_len);
+    }
+    // Copy the entire new data to the remaining space.
+    memcpy(throttle->ring + keep_len, data, size);
+    throttle->ring_len = keep_len + size;
+  }
+}
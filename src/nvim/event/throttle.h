@@ -0,0 +1,30 @@
+#ifndef NVIM_EVENT_THROTTLE_H
+#define NVIM_EVENT_THROTTLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct throttle Throttle;
+/// Called for each "pulse" while output is skipped, with the pulse count.
+typedef void (*throttle_pulse_cb)(Throttle *throttle, size_t pulse);
+
+/// Decides when output of a producer should be skipped because it arrives
+/// faster than it can be consumed, and keeps the tail of the skipped output.
+struct throttle {
+  size_t threshold;  ///< Bytes passed before skipping, 0 never skips.
+  uint64_t started;  ///< Start time of the current throttle.
+  uint64_t last;     ///< Time of the last output.
+  size_t received;   ///< Bytes observed since last throttle.
+  size_t pulse;      ///< "Pulse" count of the current throttle.
+  char *ring;        ///< Last skipped output, `threshold / 2` bytes.
+  size_t ring_len;
+  throttle_pulse_cb pulse_cb;
+};
+
+#define THROTTLE_INIT ((Throttle){ .threshold = 0, .ring = NULL, .pulse_cb = NULL })
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "event/throttle.h.generated.h"
+#endif
+#endif  // NVIM_EVENT_THROTTLE_H
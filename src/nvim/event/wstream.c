@@ -8,17 +8,24 @@
 #include <uv.h>
 
 #include "nvim/event/loop.h"
+#include "nvim/event/shm.h"
 #include "nvim/event/wstream.h"
+#include "nvim/lib/kvec.h"
 #include "nvim/log.h"
 #include "nvim/memory.h"
 #include "nvim/vim.h"
 
 #define DEFAULT_MAXMEM 1024 * 1024 * 2000
 
+/// Buffers of a uv_write() call that need no allocation, see wstream_flush().
+#define WSTREAM_INLINE_BUFS 16
+
 typedef struct {
   Stream *stream;
-  WBuffer *buffer;
   uv_write_t uv_req;
+  size_t size;      ///< Bytes in all buffers.
+  size_t nbuffers;
+  WBuffer *buffers[];
 } WRequest;
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
@@ -45,7 +52,8 @@ void wstream_init(Stream *stream, size_t maxmem)
 }
 
 /// Sets a callback that will be called on completion of a write request,
-/// indicating failure/success.
+/// indicating failure/success. A request can write several buffers, see
+/// `wstream_write()`.
 ///
 /// This affects all requests currently in-flight as well. Overwrites any
 /// possible earlier callback.
@@ -66,6 +74,9 @@ void wstream_set_write_cb(Stream *stream, stream_write_cb cb, void *data)
 /// instance. This will fail if the write would cause the Stream use more
 /// memory than specified by `maxmem`.
 ///
+/// Buffers written while an earlier request is in flight are queued and
+/// flushed together with a single `uv_write()` when it completes.
+///
 /// @param stream The `Stream` instance
 /// @param buffer The buffer which contains data to be written
 /// @return false if the write failed
@@ -80,28 +91,70 @@ bool wstream_write(Stream *stream, WBuffer *buffer)
     goto err;
   }
 
+  if (stream->shm) {
+    return shm_write(stream->shm, buffer);
+  }
+
   stream->curmem += buffer->size;
+  kv_push(stream->wqueue, buffer);
+
+  // While a write is in flight, buffers are collected and written together
+  // once it completes: the callback of a request runs on the next loop
+  // iteration, so everything written by one iteration goes out with a single
+  // writev().
+  if (stream->writing) {
+    return true;
+  }
+
+  return wstream_flush(stream);
+
+err:
+  wstream_release_wbuffer(buffer);
+  return false;
+}
+
+/// Writes all queued buffers of a stream with one uv_write() request.
+///
+/// On failure the buffers are released and the stream forgets them.
+///
+/// @return false if the request could not be queued
+static bool wstream_flush(Stream *stream)
+{
+  size_t n = kv_size(stream->wqueue);
+  if (!n) {
+    return true;
+  }
 
-  WRequest *data = xmalloc(sizeof(WRequest));
+  WRequest *data = xmalloc(sizeof(WRequest) + n * sizeof(WBuffer *));
   data->stream = stream;
-  data->buffer = buffer;
   data->uv_req.data = data;
+  data->size = 0;
+  data->nbuffers = n;
+
+  // uv_write() copies the array, only the data must stay alive.
+  uv_buf_t inline_bufs[WSTREAM_INLINE_BUFS];
+  uv_buf_t *uvbufs = n <= WSTREAM_INLINE_BUFS ? inline_bufs : xmalloc(n * sizeof(*uvbufs));
+  for (size_t i = 0; i < n; i++) {
+    WBuffer *buffer = kv_A(stream->wqueue, i);
+    data->buffers[i] = buffer;
+    data->size += buffer->size;
+    uvbufs[i] = uv_buf_init(buffer->data, UV_BUF_LEN(buffer->size));
+  }
+  kv_size(stream->wqueue) = 0;
 
-  uv_buf_t uvbuf;
-  uvbuf.base = buffer->data;
-  uvbuf.len = UV_BUF_LEN(buffer->size);
-
-  if (uv_write(&data->uv_req, stream->uvstream, &uvbuf, 1, write_cb)) {
-    xfree(data);
-    goto err;
+  int err = uv_write(&data->uv_req, stream->uvstream, uvbufs, (unsigned)n, write_cb);
+  if (uvbufs != inline_bufs) {
+    xfree(uvbufs);
+  }
+  if (err) {
+    write_release(data);
+    return false;
   }
 
   stream->pending_reqs++;
+  stream->num_writes++;
+  stream->writing = true;
   return true;
-
-err:
-  wstream_release_wbuffer(buffer);
-  return false;
 }
 
 /// Creates a WBuffer object for holding output data. Instances of this
@@ -131,25 +184,49 @@ WBuffer *wstream_new_buffer(char *data, size_t size, size_t refcount, wbuffer_da
 static void write_cb(uv_write_t *req, int status)
 {
   WRequest *data = req->data;
+  Stream *stream = data->stream;
 
-  data->stream->curmem -= data->buffer->size;
+  write_release(data);
+  stream->writing = false;
 
-  wstream_release_wbuffer(data->buffer);
+  if (stream->write_cb) {
+    stream->write_cb(stream, stream->cb_data, status);
+  }
 
-  if (data->stream->write_cb) {
-    data->stream->write_cb(data->stream, data->stream->cb_data, status);
+  // Buffers queued before the stream was closed are still written.
+  if (status || !wstream_flush(stream)) {
+    wstream_clear(stream);
   }
 
-  data->stream->pending_reqs--;
+  stream->pending_reqs--;
 
-  if (data->stream->closed && data->stream->pending_reqs == 0) {
+  if (stream->closed && stream->pending_reqs == 0) {
     // Last pending write, free the stream;
-    stream_close_handle(data->stream);
+    stream_close_handle(stream);
   }
+}
 
+/// Releases the buffers of a request and frees it.
+static void write_release(WRequest *data)
+{
+  data->stream->curmem -= data->size;
+  for (size_t i = 0; i < data->nbuffers; i++) {
+    wstream_release_wbuffer(data->buffers[i]);
+  }
   xfree(data);
 }
 
+/// Releases the buffers queued for a stream that were not written yet.
+static void wstream_clear(Stream *stream)
+{
+  for (size_t i = 0; i < kv_size(stream->wqueue); i++) {
+    WBuffer *buffer = kv_A(stream->wqueue, i);
+    stream->curmem -= buffer->size;
+    wstream_release_wbuffer(buffer);
+  }
+  kv_size(stream->wqueue) = 0;
+}
+
 void wstream_release_wbuffer(WBuffer *buffer)
   FUNC_ATTR_NONNULL_ALL
 {
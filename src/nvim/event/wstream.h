@@ -8,7 +8,6 @@
 #include "nvim/event/loop.h"
 #include "nvim/event/stream.h"
 
-typedef struct wbuffer WBuffer;
 typedef void (*wbuffer_data_finalizer)(void *data);
 
 struct wbuffer {
@@ -2921,6 +2921,12 @@ module.cmds = {
     addr_type='ADDR_OTHER',
     func='ex_tag',
   },
+  {
+    command='trace',
+    flags=bit.bor(EXTRA, TRLBAR, CMDWIN),
+    addr_type='ADDR_NONE',
+    func='ex_trace',
+  },
   {
     command='try',
     flags=bit.bor(TRLBAR, SBOXOK, CMDWIN),
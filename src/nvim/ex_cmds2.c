@@ -136,6 +136,26 @@ void ex_profile(exarg_T *eap)
   }
 }
 
+/// ":trace start {fname}" and ":trace stop"
+void ex_trace(exarg_T *eap)
+{
+  char_u *e = skiptowhite(eap->arg);
+  int len = (int)(e - eap->arg);
+  e = skipwhite(e);
+
+  if (len == 5 && STRNCMP(eap->arg, "start", 5) == 0 && *e != NUL) {
+    char_u *fname = expand_env_save_opt(e, true);
+    if (!trace_start((char *)fname)) {
+      semsg(_(e_notopen), fname);
+    }
+    xfree(fname);
+  } else if (STRCMP(eap->arg, "stop") == 0) {
+    trace_stop();
+  } else {
+    semsg(_(e_invarg2), eap->arg);
+  }
+}
+
 void ex_ruby(exarg_T *eap)
 {
   script_host_execute("ruby", eap);
@@ -45,6 +45,7 @@
 #include "nvim/os/time.h"
 #include "nvim/os_unix.h"
 #include "nvim/path.h"
+#include "nvim/profile.h"
 #include "nvim/quickfix.h"
 #include "nvim/regexp.h"
 #include "nvim/screen.h"
@@ -703,6 +704,8 @@ int readfile(char_u *fname, char_u *sfname, linenr_T from, linenr_T lines_to_ski
     fenc = next_fenc(&fenc_next, &fenc_alloced);
   }
 
+  TRACE_BEGIN("io", "read %s", fname == NULL ? "-" : (char *)fname);
+
   /*
    * Jump back here to retry reading the file in different ways.
    * Reasons to retry:
@@ -1711,6 +1714,7 @@ failed:
     (void)os_set_cloexec(fd);
   }
   xfree(buffer);
+  TRACE_END();
 
   if (read_stdin) {
     close(0);
@@ -2550,6 +2554,8 @@ int buf_write(buf_T *buf, char_u *fname, char_u *sfname, linenr_T start, linenr_
     bufsize = BUFSIZE;
   }
 
+  TRACE_BEGIN("io", "write %s", (char *)fname);
+
   /*
    * Get information about original file (if there is one).
    */
@@ -3751,6 +3757,7 @@ nofail:
 
   got_int |= prev_got_int;
 
+  TRACE_END();
   return retval;
 #undef SET_ERRMSG
 #undef SET_ERRMSG_ARG
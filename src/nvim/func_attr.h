@@ -207,6 +207,8 @@
 #ifdef DEFINE_FUNC_ATTRIBUTES
 /// Fast (non-deferred) API function.
 # define FUNC_API_FAST
+/// Read-only API function, may be served without a main loop iteration.
+# define FUNC_API_READONLY
 /// Internal C function not exposed in the RPC API.
 # define FUNC_API_NOEXPORT
 /// API function not exposed in VimL/eval.
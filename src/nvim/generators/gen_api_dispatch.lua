@@ -68,6 +68,13 @@ for i = 6, #arg do
         -- for specifying errors
         fn.parameters[#fn.parameters] = nil
       end
+      if #fn.parameters ~= 0 and fn.parameters[#fn.parameters][1] == 'arena' then
+        -- return value is allocated in an arena
+        fn.arena_return = true
+        fn.parameters[#fn.parameters] = nil
+      end
+      -- fast functions are already invoked immediately
+      assert(not (fn.fast and fn.readonly), fn.name..': FAST and READONLY')
     end
   end
   input:close()
@@ -206,7 +213,7 @@ for i = 1, #functions do
   if fn.impl_name == nil and fn.remote then
     local args = {}
 
-    output:write('Object handle_'..fn.name..'(uint64_t channel_id, Array args, Error *error)')
+    output:write('Object handle_'..fn.name..'(uint64_t channel_id, Array args, Arena *arena, Error *error)')
     output:write('\n{')
     output:write('\n#if MIN_LOG_LEVEL <= DEBUG_LOG_LEVEL')
     output:write('\n  logmsg(DEBUG_LOG_LEVEL, "RPC: ", NULL, -1, true, "ch %" PRIu64 ": invoke '
@@ -304,6 +311,12 @@ for i = 1, #functions do
     -- write the function name and the opening parenthesis
     output:write(fn.name..'(')
 
+    if fn.arena_return then
+      -- the return value is allocated in the arena of the caller
+      args[#args + 1] = 'arena'
+      call_args = table.concat(args, ', ')
+    end
+
     if fn.receives_channel_id then
       -- if the function receives the channel id, pass it as first argument
       if #args > 0 or fn.can_fail then
@@ -345,6 +358,7 @@ void msgpack_rpc_init_method_table(void)
 {
 ]])
 
+local remote_count = 0
 for i = 1, #functions do
   local fn = functions[i]
   if fn.remote then
@@ -352,7 +366,12 @@ for i = 1, #functions do
                    '(String) {.data = "'..fn.name..'", '..
                    '.size = sizeof("'..fn.name..'") - 1}, '..
                    '(MsgpackRpcRequestHandler) {.fn = handle_'..  (fn.impl_name or fn.name)..
-                   ', .fast = '..tostring(fn.fast)..'});\n')
+                   ', .name = "'..fn.name..'"'..
+                   ', .id = '..remote_count..
+                   ', .fast = '..tostring(fn.fast)..
+                   ', .readonly = '..tostring(not not fn.readonly)..
+                   ', .arena_return = '..tostring(not not fn.arena_return)..'});\n')
+      remote_count = remote_count + 1
   end
 end
 
@@ -470,6 +489,12 @@ local function process_function(fn)
   if fn.receives_channel_id then
     cparams = 'LUA_INTERNAL_CALL, ' .. cparams
   end
+  if fn.arena_return then
+    cparams = cparams .. '&arena, '
+    write_shifted_output(output, [[
+    Arena arena = ARENA_EMPTY;
+    ]])
+  end
   if fn.can_fail then
     cparams = cparams .. '&err'
   else
@@ -504,14 +529,20 @@ local function process_function(fn)
     else
       return_type = fn.return_type
     end
+    local free_retval
+    if fn.arena_return then
+      free_retval = 'arena_mem_free(arena_finish(&arena));'
+    else
+      free_retval = ('api_free_%s(ret);'):format(return_type:lower())
+    end
     write_shifted_output(output, string.format([[
     const %s ret = %s(%s);
     nlua_push_%s(lstate, ret, true);
-    api_free_%s(ret);
+    %s
   %s
   %s
     return 1;
-    ]], fn.return_type, fn.name, cparams, return_type, return_type:lower(),
+    ]], fn.return_type, fn.name, cparams, return_type, free_retval,
         free_at_exit_code, err_throw_code))
   else
     write_shifted_output(output, string.format([[
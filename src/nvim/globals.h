@@ -76,7 +76,24 @@
 EXTERN struct nvim_stats_s {
   int64_t fsync;
   int64_t redraw;
-} g_stats INIT(= { 0, 0 });
+  int64_t tui_writes;       ///< Writes to the host terminal (TUI thread).
+  int64_t tui_bytes;        ///< Bytes written to the host terminal.
+  int64_t tui_frame_bytes;  ///< Size of the last write to the host terminal.
+  int64_t term_bytes;       ///< Bytes received by :terminal buffers.
+  int64_t term_damage;      ///< Damage callbacks from libvterm, merged per refresh.
+  int64_t term_refreshes;   ///< Refreshes of :terminal buffers.
+} g_stats INIT(= { 0, 0, 0, 0, 0, 0, 0, 0 });
+
+// Access to the g_stats counters updated by the TUI thread.
+#ifdef _MSC_VER
+# define STATS_LOAD(p) InterlockedCompareExchange64((volatile LONG64 *)(p), 0, 0)
+# define STATS_STORE(p, v) ((void)InterlockedExchange64((volatile LONG64 *)(p), (v)))
+# define STATS_ADD(p, v) ((void)InterlockedExchangeAdd64((volatile LONG64 *)(p), (v)))
+#else
+# define STATS_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+# define STATS_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+# define STATS_ADD(p, v) ((void)__atomic_add_fetch((p), (v), __ATOMIC_RELAXED))
+#endif
 
 // Values for "starting".
 #define NO_SCREEN       2       // no screen updating yet
@@ -1011,6 +1028,7 @@ EXTERN char line_msg[] INIT(= N_(" line "));
 EXTERN time_t starttime;
 
 EXTERN FILE *time_fd INIT(= NULL);  // where to write startup timing
+EXTERN FILE *trace_fd INIT(= NULL);  // where to write trace events, see :trace
 
 // Some compilers warn for not using a return value, but in some situations we
 // can't do anything useful with the value.  Assign to this variable to avoid
@@ -618,10 +618,9 @@ bool nlua_push_typval(lua_State *lstate, typval_T *const tv, bool special)
     return false;
   }
   if (tv->v_type == VAR_FUNC) {
-    ufunc_T *fp = find_func(tv->vval.v_string);
-    assert(fp != NULL);
-    if (fp->uf_cb == nlua_CFunction_func_call) {
-      nlua_pushref(lstate, ((LuaCFunctionState *)fp->uf_cb_state)->lua_callable.func_ref);
+    LuaRef ref = nlua_funcref_luaref(tv->vval.v_string);
+    if (ref != LUA_NOREF) {
+      nlua_pushref(lstate, ref);
       return true;
     }
   }
@@ -632,6 +631,20 @@ bool nlua_push_typval(lua_State *lstate, typval_T *const tv, bool special)
   return true;
 }
 
+/// Gets the Lua function behind a funcref created by nlua_pop_typval().
+///
+/// @return LUA_NOREF if `name` is not the name of such a function, or of no
+///         defined function at all (e.g. a builtin or autoload function).
+LuaRef nlua_funcref_luaref(const char_u *name)
+  FUNC_ATTR_NONNULL_ALL
+{
+  ufunc_T *fp = find_func(name);
+  if (fp == NULL || fp->uf_cb != nlua_CFunction_func_call) {
+    return LUA_NOREF;
+  }
+  return ((LuaCFunctionState *)fp->uf_cb_state)->lua_callable.func_ref;
+}
+
 /// Push value which is a type index
 ///
 /// Used for all “typed” tables: i.e. for all tables which represent VimL
@@ -35,6 +35,7 @@
 #include "nvim/message.h"
 #include "nvim/msgpack_rpc/channel.h"
 #include "nvim/os/os.h"
+#include "nvim/profile.h"
 #include "nvim/screen.h"
 #include "nvim/undo.h"
 #include "nvim/version.h"
@@ -137,7 +138,9 @@ static int nlua_luv_cfpcall(lua_State *lstate, int nargs, int nresult, int flags
   in_fast_callback++;
 
   int top = lua_gettop(lstate);
+  TRACE_BEGIN("lua", "luv callback");
   int status = nlua_pcall(lstate, nargs, nresult);
+  TRACE_END();
   if (status) {
     if (status == LUA_ERRMEM && !(flags & LUVF_CALLBACK_NOEXIT)) {
       // consider out of memory errors unrecoverable, just like xmalloc()
@@ -168,7 +171,10 @@ static void nlua_schedule_event(void **argv)
   lua_State *const lstate = global_lstate;
   nlua_pushref(lstate, cb);
   nlua_unref(lstate, cb);
-  if (nlua_pcall(lstate, 0, 0)) {
+  TRACE_BEGIN("lua", "vim.schedule callback");
+  int status = nlua_pcall(lstate, 0, 0);
+  TRACE_END();
+  if (status) {
     nlua_error(lstate, _("Error executing vim.schedule lua callback: %.*s"));
   }
 }
@@ -1085,7 +1091,10 @@ Object nlua_call_ref(LuaRef ref, const char *name, Array args, bool retval, Erro
     nlua_push_Object(lstate, args.items[i], false);
   }
 
-  if (nlua_pcall(lstate, nargs, retval ? 1 : 0)) {
+  TRACE_BEGIN("lua", "%s", name ? name : "callback");
+  int status = nlua_pcall(lstate, nargs, retval ? 1 : 0);
+  TRACE_END();
+  if (status) {
     // if err is passed, the caller will deal with the error.
     if (err) {
       size_t len;
@@ -114,6 +114,8 @@ static const char *err_extra_cmd =
 void event_init(void)
 {
   loop_init(&main_loop, NULL);
+  // Not in the high lane: nvim_ui_try_resize requests are queued here, and
+  // must not run before earlier requests of the same channel.
   resize_events = multiqueue_new_child(main_loop.events);
 
   // early msgpack-rpc initialization
@@ -683,6 +685,7 @@ void getout(int exitval)
   }
 
   profile_dump();
+  trace_stop();
 
   if (did_emsg) {
     // give the user a chance to read the (error) message
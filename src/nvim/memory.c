@@ -523,6 +523,105 @@ void time_to_bytes(time_t time_, uint8_t buf[8])
   }
 }
 
+// Blocks of finished arenas kept for reuse, see arena_mem_free(). Arenas are
+// only used by the main thread.
+#define ARENA_REUSE_MAX 8
+static ArenaMem arena_reuse_blk = NULL;
+static size_t arena_reuse_count = 0;
+
+#define ARENA_ALIGN MAX(sizeof(void *), sizeof(double))
+
+static void arena_alloc_block(Arena *arena)
+{
+  ArenaMem blk;
+  if (arena_reuse_blk) {
+    blk = arena_reuse_blk;
+    arena_reuse_blk = blk->prev;
+    arena_reuse_count--;
+  } else {
+    blk = xmalloc(ARENA_BLOCK_SIZE);
+    blk->size = ARENA_BLOCK_SIZE;
+  }
+  blk->prev = (ArenaMem)arena->cur_blk;
+  arena->cur_blk = (char *)blk;
+  arena->pos = sizeof(struct consumed_blk);
+  arena->size = ARENA_BLOCK_SIZE;
+}
+
+/// Allocates `size` bytes from `arena`, to be freed with everything else
+/// allocated from it by arena_mem_free().
+///
+/// @param arena  Arena, or NULL to allocate with xmalloc() instead.
+/// @param align  Align the memory for any type, not needed for strings.
+void *arena_alloc(Arena *arena, size_t size, bool align)
+  FUNC_ATTR_NONNULL_RET
+{
+  if (!arena) {
+    return xmalloc(size);
+  }
+  if (align) {
+    arena->pos = (arena->pos + (ARENA_ALIGN - 1)) & ~(ARENA_ALIGN - 1);
+  }
+  if (arena->pos + size > arena->size) {
+    if (size > (ARENA_BLOCK_SIZE - sizeof(struct consumed_blk)) / 2) {
+      // Big allocations get a block of their own, the current block is kept.
+      ArenaMem blk = xmalloc(sizeof(struct consumed_blk) + size);
+      blk->size = sizeof(struct consumed_blk) + size;
+      if (arena->cur_blk) {
+        blk->prev = ((ArenaMem)arena->cur_blk)->prev;
+        ((ArenaMem)arena->cur_blk)->prev = blk;
+      } else {
+        blk->prev = NULL;
+        arena->cur_blk = (char *)blk;
+        arena->pos = arena->size = blk->size;
+      }
+      return (char *)blk + sizeof(struct consumed_blk);
+    }
+    arena_alloc_block(arena);
+  }
+  char *mem = arena->cur_blk + arena->pos;
+  arena->pos += size;
+  return mem;
+}
+
+/// Copies `size` bytes of `buf` into `arena`, adding a NUL.
+char *arena_memdupz(Arena *arena, const char *buf, size_t size)
+  FUNC_ATTR_NONNULL_ARG(2) FUNC_ATTR_NONNULL_RET
+{
+  char *mem = arena_alloc(arena, size + 1, false);
+  memcpy(mem, buf, size);
+  mem[size] = '\0';
+  return mem;
+}
+
+/// Takes the memory allocated from `arena` and resets it.
+///
+/// @return Memory to free with arena_mem_free(), possibly NULL.
+ArenaMem arena_finish(Arena *arena)
+  FUNC_ATTR_NONNULL_ALL
+{
+  ArenaMem mem = (ArenaMem)arena->cur_blk;
+  *arena = (Arena)ARENA_EMPTY;
+  return mem;
+}
+
+/// Frees memory taken with arena_finish(). A few blocks are kept, so that
+/// an arena used for each request does not call malloc() at all.
+void arena_mem_free(ArenaMem mem)
+{
+  while (mem) {
+    ArenaMem prev = mem->prev;
+    if (mem->size == ARENA_BLOCK_SIZE && arena_reuse_count < ARENA_REUSE_MAX) {
+      mem->prev = arena_reuse_blk;
+      arena_reuse_blk = mem;
+      arena_reuse_count++;
+    } else {
+      xfree(mem);
+    }
+    mem = prev;
+  }
+}
+
 #if defined(EXITFREE)
 
 # include "nvim/buffer.h"
@@ -706,6 +805,13 @@ void free_all_mem(void)
   decor_free_all_mem();
 
   nlua_free_all_mem();
+
+  while (arena_reuse_blk) {
+    ArenaMem blk = arena_reuse_blk;
+    arena_reuse_blk = blk->prev;
+    xfree(blk);
+  }
+  arena_reuse_count = 0;
 }
 
 #endif
@@ -32,6 +32,22 @@ extern MemCalloc mem_calloc;
 extern MemRealloc mem_realloc;
 #endif
 
+/// Memory taken from an Arena by arena_finish(): a chain of blocks.
+typedef struct consumed_blk {
+  struct consumed_blk *prev;
+  size_t size;
+} *ArenaMem;
+
+/// Bump allocator: memory is allocated from blocks with arena_alloc() and
+/// freed all at once with arena_mem_free().
+typedef struct {
+  char *cur_blk;
+  size_t pos, size;
+} Arena;
+
+#define ARENA_EMPTY { .cur_blk = NULL, .pos = 0, .size = 0 }
+#define ARENA_BLOCK_SIZE 4096
+
 #ifdef EXITFREE
 /// Indicates that free_all_mem function was or is running
 extern bool entered_free_all_mem;
@@ -16,8 +16,10 @@
 #include "nvim/event/libuv_process.h"
 #include "nvim/event/loop.h"
 #include "nvim/event/rstream.h"
+#include "nvim/event/shm.h"
 #include "nvim/event/socket.h"
 #include "nvim/event/wstream.h"
+#include "nvim/fileio.h"
 #include "nvim/lib/kvec.h"
 #include "nvim/log.h"
 #include "nvim/main.h"
@@ -26,8 +28,13 @@
 #include "nvim/message.h"
 #include "nvim/msgpack_rpc/channel.h"
 #include "nvim/msgpack_rpc/helpers.h"
+#include "nvim/msgpack_rpc/packer.h"
+#include "nvim/msgpack_rpc/unpacker.h"
 #include "nvim/os/input.h"
+#include "nvim/os/os.h"
+#include "nvim/os/time.h"
 #include "nvim/os_unix.h"
+#include "nvim/profile.h"
 #include "nvim/ui.h"
 #include "nvim/vim.h"
 
@@ -37,7 +44,6 @@
 #endif
 
 static PMap(cstr_t) event_strings = MAP_INIT;
-static msgpack_sbuffer out_buffer;
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "msgpack_rpc/channel.c.generated.h"
@@ -46,7 +52,6 @@ static msgpack_sbuffer out_buffer;
 void rpc_init(void)
 {
   ch_before_blocking_events = multiqueue_new_child(main_loop.events);
-  msgpack_sbuffer_init(&out_buffer);
 }
 
 
@@ -56,9 +61,13 @@ void rpc_start(Channel *channel)
   channel->is_rpc = true;
   RpcState *rpc = &channel->rpc;
   rpc->closed = false;
-  rpc->unpacker = msgpack_unpacker_new(MSGPACK_UNPACKER_INIT_BUFFER_SIZE);
+  rpc->unpacker = xmalloc(sizeof(Unpacker));
+  unpacker_init(rpc->unpacker);
   rpc->next_request_id = 1;
   rpc->info = (Dictionary)ARRAY_DICT_INIT;
+  rpc->shm = NULL;
+  rpc->stats = (RpcStats) { 0 };
+  kv_init(rpc->stats.methods);
   kv_init(rpc->call_stack);
 
   if (channel->streamtype != kChannelStreamInternal) {
@@ -70,9 +79,26 @@ void rpc_start(Channel *channel)
 #endif
 
     rstream_start(out, receive_msgpack, channel);
+    wstream_set_write_cb(channel_instream(channel), rpc_write_cb, channel);
   }
 }
 
+static void rpc_write_cb(Stream *stream, void *data, int status)
+{
+  Channel *channel = data;
+  remote_ui_output_written(channel->id, stream->curmem);
+}
+
+/// Gets the number of bytes queued for the channel that are not written yet.
+size_t rpc_pending_bytes(uint64_t id)
+{
+  Channel *channel = find_rpc_channel(id);
+  if (!channel || channel->streamtype == kChannelStreamInternal) {
+    return 0;
+  }
+  return channel_instream(channel)->curmem;
+}
+
 
 static Channel *find_rpc_channel(uint64_t id)
 {
@@ -164,6 +190,77 @@ Object rpc_send_call(uint64_t id, const char *method_name, Array args, Error *er
   return frame.errored ? NIL : frame.result;
 }
 
+/// Switches a socket channel to shared memory, if the server supports it.
+/// Otherwise the channel keeps using the socket.
+void rpc_shm_connect(Channel *channel)
+{
+  char *path;
+  if (os_isdir((char_u *)"/dev/shm")) {
+    static unsigned count = 0;
+    char buf[64];
+    snprintf(buf, sizeof(buf), "/dev/shm/nvim-shm.%" PRId64 ".%u",
+             os_get_pid(), count++);
+    path = xstrdup(buf);
+  } else {
+    path = (char *)vim_tempname();
+  }
+  if (!path) {
+    return;
+  }
+
+  const char *error = NULL;
+  ShmTransport *shm = shm_create(path, SHM_RING_SIZE, &error);
+  if (!shm) {
+    WLOG("ch %" PRIu64 ": shared memory not created: %s", channel->id, error);
+    xfree(path);
+    return;
+  }
+
+  // Nothing else is sent until the response arrives, which is the last
+  // message read from the socket.
+  Array args = ARRAY_DICT_INIT;
+  ADD(args, STRING_OBJ(cstr_to_string(path)));
+  Error err = ERROR_INIT;
+  channel_incref(channel);
+  api_free_object(rpc_send_call(channel->id, "nvim__chan_shm", args, &err));
+  os_remove(path);
+  xfree(path);
+
+  if (ERROR_SET(&err) || channel->rpc.closed) {
+    DLOG("ch %" PRIu64 ": using the socket: %s", channel->id,
+         ERROR_SET(&err) ? err.msg : "closed");
+    shm_free(shm);
+  } else {
+    shm_start(shm, channel_instream(channel));
+  }
+  channel_decref(channel);
+  api_clear_error(&err);
+}
+
+/// Maps the shared memory created by the client of a socket channel, see
+/// nvim__chan_shm(). The channel switches to it once the response to the
+/// current request is written.
+void rpc_shm_attach(uint64_t id, const char *path, Error *err)
+{
+  Channel *channel = find_rpc_channel(id);
+  if (!channel || channel->streamtype != kChannelStreamSocket
+      || channel->stream.socket.uvstream->type != UV_NAMED_PIPE) {
+    api_set_error(err, kErrorTypeException,
+                  "Shared memory requires a local socket channel");
+    return;
+  }
+  if (channel->stream.socket.shm || channel->rpc.shm) {
+    api_set_error(err, kErrorTypeException, "Shared memory already in use");
+    return;
+  }
+
+  const char *error = NULL;
+  channel->rpc.shm = shm_attach(path, &error);
+  if (!channel->rpc.shm) {
+    api_set_error(err, kErrorTypeException, "Failed to map %s: %s", path, error);
+  }
+}
+
 /// Subscribes to event broadcasts
 ///
 /// @param id The channel id
@@ -215,36 +312,42 @@ static void receive_msgpack(Stream *stream, RBuffer *rbuf, size_t c, void *data,
     goto end;
   }
 
-  size_t count = rbuffer_size(rbuf);
   DLOG("ch %" PRIu64 ": parsing %zu bytes from msgpack Stream: %p",
-       channel->id, count, (void *)stream);
-
-  // Feed the unpacker with data
-  msgpack_unpacker_reserve_buffer(channel->rpc.unpacker, count);
-  rbuffer_read(rbuf, msgpack_unpacker_buffer(channel->rpc.unpacker), count);
-  msgpack_unpacker_buffer_consumed(channel->rpc.unpacker, count);
+       channel->id, rbuffer_size(rbuf), (void *)stream);
 
-  parse_msgpack(channel);
+  // Parse straight from the buffer. Data is only written to it when libuv
+  // reads, so consumed data stays valid while it is parsed, and it is
+  // consumed first in case a handler processes events.
+  while (rbuffer_size(rbuf)) {
+    size_t count;
+    const char *ptr = rbuffer_read_ptr(rbuf, &count);
+    rbuffer_consumed(rbuf, count);
+    parse_msgpack(channel, ptr, count);
+  }
 
 end:
   channel_decref(channel);
 }
 
-static void parse_msgpack(Channel *channel)
+static void parse_msgpack(Channel *channel, const char *data, size_t size)
 {
-  msgpack_unpacked unpacked;
-  msgpack_unpacked_init(&unpacked);
-  msgpack_unpack_return result;
+  Unpacker *unpacker = channel->rpc.unpacker;
+  UnpackerStatus result = kUnpackerMore;
+  channel->rpc.stats.bytes_in += size;
 
   // Deserialize everything we can.
-  while ((result = msgpack_unpacker_next(channel->rpc.unpacker, &unpacked)) ==
-         MSGPACK_UNPACK_SUCCESS) {
-    bool is_response = is_rpc_response(&unpacked.data);
-    log_client_msg(channel->id, !is_response, unpacked.data);
+  while (size
+         && (result = unpacker_advance(unpacker, &data, &size)) == kUnpackerDone) {
+    bool invalid;
+    ArenaMem mem;
+    Object msg = unpacker_take(unpacker, &invalid, &mem);
+    bool is_response = is_rpc_response(&msg);
+    log_client_msg(channel->id, !is_response, msg);
 
     if (is_response) {
-      if (is_valid_rpc_response(&unpacked.data, channel)) {
-        complete_call(&unpacked.data, channel);
+      if (is_valid_rpc_response(&msg, channel)) {
+        channel->rpc.stats.responses++;
+        complete_call(&msg, channel);
       } else {
         char buf[256];
         snprintf(buf, sizeof(buf),
@@ -253,26 +356,18 @@ static void parse_msgpack(Channel *channel)
                  channel->id);
         call_set_error(channel, buf, ERROR_LOG_LEVEL);
       }
-      msgpack_unpacked_destroy(&unpacked);
+      arena_mem_free(mem);
     } else {
-      handle_request(channel, &unpacked.data);
+      handle_request(channel, msg, mem, invalid);
     }
   }
 
-  if (result == MSGPACK_UNPACK_NOMEM_ERROR) {
-    mch_errmsg(e_outofmem);
-    mch_errmsg("\n");
-    channel_decref(channel);
-    preserve_exit();
-  }
-
-  if (result == MSGPACK_UNPACK_PARSE_ERROR) {
-    // See src/msgpack/unpack_template.h in msgpack source tree for
-    // causes for this error(search for 'goto _failed')
-    //
-    // A not so uncommon cause for this might be deserializing objects with
-    // a high nesting level: msgpack will break when its internal parse stack
-    // size exceeds MSGPACK_EMBED_STACK_SIZE (defined as 32 by default)
+  if (result == kUnpackerError) {
+    // Besides malformed data, this is caused by nesting deeper than
+    // UNPACKER_MAX_DEPTH and by arrays or dictionaries used as keys. The
+    // rest of the data cannot be parsed reliably, start over with the next.
+    unpacker_teardown(unpacker);
+    unpacker_init(unpacker);
     send_error(channel, kMessageTypeRequest, 0,
                "Invalid msgpack payload. "
                "This error can also happen when deserializing "
@@ -281,12 +376,17 @@ static void parse_msgpack(Channel *channel)
 }
 
 /// Handles requests and notifications received on the channel.
-static void handle_request(Channel *channel, msgpack_object *request)
-  FUNC_ATTR_NONNULL_ALL
+///
+/// @param request  Message.
+/// @param mem      Memory of the message, freed by this function or, for the
+///                 arguments, by request_event().
+/// @param invalid  Parts of the message could not be unpacked.
+static void handle_request(Channel *channel, Object request, ArenaMem mem, bool invalid)
+  FUNC_ATTR_NONNULL_ARG(1)
 {
   uint32_t request_id;
   Error error = ERROR_INIT;
-  MessageType type = msgpack_rpc_validate(&request_id, request, &error);
+  MessageType type = msgpack_rpc_validate(&request_id, &request, &error);
 
   if (ERROR_SET(&error)) {
     // Validation failed, send response with error
@@ -295,8 +395,7 @@ static void handle_request(Channel *channel, msgpack_object *request)
                                          type,
                                          request_id,
                                          &error,
-                                         NIL,
-                                         &out_buffer))) {
+                                         NIL))) {
       char buf[256];
       snprintf(buf, sizeof(buf),
                "ch %" PRIu64 " sent an invalid message, closed.",
@@ -304,27 +403,29 @@ static void handle_request(Channel *channel, msgpack_object *request)
       call_set_error(channel, buf, ERROR_LOG_LEVEL);
     }
     api_clear_error(&error);
+    arena_mem_free(mem);
     return;
   }
   assert(type == kMessageTypeRequest || type == kMessageTypeNotification);
+  if (type == kMessageTypeRequest) {
+    channel->rpc.stats.requests++;
+  } else {
+    channel->rpc.stats.notifications++;
+  }
 
   MsgpackRpcRequestHandler handler;
-  msgpack_object *method = msgpack_rpc_method(request);
-  handler = msgpack_rpc_get_handler_for(method->via.bin.ptr,
-                                        method->via.bin.size,
-                                        &error);
+  String *method = msgpack_rpc_method(&request);
+  handler = msgpack_rpc_get_handler_for(method->data, method->size, &error);
 
   // check method arguments
-  Array args = ARRAY_DICT_INIT;
-  if (!ERROR_SET(&error)
-      && !msgpack_rpc_to_array(msgpack_rpc_args(request), &args)) {
+  if (!ERROR_SET(&error) && invalid) {
     api_set_error(&error, kErrorTypeException, "Invalid method arguments");
   }
 
   if (ERROR_SET(&error)) {
     send_error(channel, type, request_id, error.msg);
     api_clear_error(&error);
-    api_free_array(args);
+    arena_mem_free(mem);
     return;
   }
 
@@ -332,8 +433,10 @@ static void handle_request(Channel *channel, msgpack_object *request)
   evdata->type = type;
   evdata->channel = channel;
   evdata->handler = handler;
-  evdata->args = args;
+  evdata->args = *msgpack_rpc_args(&request);
+  evdata->used_mem = mem;
   evdata->request_id = request_id;
+  evdata->received = os_hrtime();
   channel_incref(channel);
   if (handler.fast) {
     bool is_get_mode = handler.fn == handle_nvim_get_mode;
@@ -345,6 +448,13 @@ static void handle_request(Channel *channel, msgpack_object *request)
       // Invoke immediately.
       request_event((void **)&evdata);
     }
+  } else if (handler.readonly && input_idle()
+             && multiqueue_empty(main_loop.events)) {
+    // Nothing is executing and no event is waiting, not even an earlier
+    // request of the channel, so the state is the same as when the event
+    // would be processed. Skip the main loop iteration, so that polling
+    // clients don't cause redraws and the like.
+    request_event((void **)&evdata);
   } else {
     bool is_resize = handler.fn == handle_nvim_ui_try_resize;
     if (is_resize) {
@@ -354,7 +464,9 @@ static void handle_request(Channel *channel, msgpack_object *request)
       multiqueue_put_event(resize_events, ev);
     } else {
       multiqueue_put(channel->events, request_event, 1, evdata);
-      DLOG("RPC: scheduled %.*s", method->via.bin.size, method->via.bin.ptr);
+      channel->rpc.stats.queue_max = MAX(channel->rpc.stats.queue_max,
+                                         multiqueue_size(channel->events));
+      DLOG("RPC: scheduled %.*s", (int)method->size, method->data);
     }
   }
 }
@@ -373,23 +485,44 @@ static void request_event(void **argv)
     // channel was closed, abort any pending requests
     goto free_ret;
   }
-  Object result = handler.fn(channel->id, e->args, &error);
+  // Functions which opted in (arena_return) allocate the result here.
+  Arena res_arena = ARENA_EMPTY;
+  uint64_t start = os_hrtime();
+  TRACE_BEGIN("rpc", "%s", handler.name ? handler.name : "request");
+  Object result = handler.fn(channel->id, e->args, &res_arena, &error);
+  TRACE_END();
+  uint64_t elapsed = os_hrtime() - start;
+  // The method may have run nested requests, which grow the stats.
+  RpcMethodStats *stats = rpc_method_stats(channel, handler);
+  stats->calls++;
+  stats->errors += ERROR_SET(&error);
+  stats->handle_ns += elapsed;
+  stats->handle_hist[rpc_latency_bucket(elapsed)]++;
   if (e->type == kMessageTypeRequest || ERROR_SET(&error)) {
     // Send the response.
-    msgpack_packer response;
-    msgpack_packer_init(&response, &out_buffer, msgpack_sbuffer_write);
     channel_write(channel, serialize_response(channel->id,
                                               e->type,
                                               e->request_id,
                                               &error,
-                                              result,
-                                              &out_buffer));
-  } else {
+                                              result));
+    if (e->type == kMessageTypeRequest) {
+      stats->response_hist[rpc_latency_bucket(os_hrtime() - e->received)]++;
+    }
+  }
+  if (!handler.arena_return) {
     api_free_object(result);
   }
+  arena_mem_free(arena_finish(&res_arena));
+  if (channel->rpc.shm && !channel->rpc.closed) {
+    // The client reads the response from the socket, everything after it
+    // goes through the shared memory.
+    shm_start(channel->rpc.shm, channel_instream(channel));
+    channel->rpc.shm = NULL;
+  }
 
 free_ret:
-  api_free_array(e->args);
+  // e->args is owned by the arena of the message.
+  arena_mem_free(e->used_mem);
   channel_decref(channel);
   xfree(e);
   api_clear_error(&error);
@@ -404,6 +537,8 @@ static bool channel_write(Channel *channel, WBuffer *buffer)
     return false;
   }
 
+  channel->rpc.stats.bytes_out += buffer->size;
+
   if (channel->streamtype == kChannelStreamInternal) {
     channel_incref(channel);
     CREATE_EVENT(channel->events, internal_read_event, 2, channel, buffer);
@@ -433,12 +568,7 @@ static void internal_read_event(void **argv)
   Channel *channel = argv[0];
   WBuffer *buffer = argv[1];
 
-  msgpack_unpacker_reserve_buffer(channel->rpc.unpacker, buffer->size);
-  memcpy(msgpack_unpacker_buffer(channel->rpc.unpacker),
-         buffer->data, buffer->size);
-  msgpack_unpacker_buffer_consumed(channel->rpc.unpacker, buffer->size);
-
-  parse_msgpack(channel);
+  parse_msgpack(channel, buffer->data, buffer->size);
 
   channel_decref(channel);
   wstream_release_wbuffer(buffer);
@@ -452,8 +582,7 @@ static void send_error(Channel *chan, MessageType type, uint32_t id, char *err)
                                          type,
                                          id,
                                          &e,
-                                         NIL,
-                                         &out_buffer));
+                                         NIL));
   api_clear_error(&e);
 }
 
@@ -464,7 +593,6 @@ static void send_request(Channel *channel, uint32_t id, const char *name, Array
                                            id,
                                            method,
                                            args,
-                                           &out_buffer,
                                            1));
 }
 
@@ -475,7 +603,6 @@ static void send_event(Channel *channel, const char *name, Array args)
                                            0,
                                            method,
                                            args,
-                                           &out_buffer,
                                            1));
 }
 
@@ -501,7 +628,6 @@ static void broadcast_event(const char *name, Array args)
                                       0,
                                       method,
                                       args,
-                                      &out_buffer,
                                       kv_size(subscribed));
 
   for (size_t i = 0; i < kv_size(subscribed); i++) {
@@ -562,7 +688,8 @@ static void exit_event(void **argv)
 void rpc_free(Channel *channel)
 {
   remote_ui_disconnect(channel->id);
-  msgpack_unpacker_free(channel->rpc.unpacker);
+  unpacker_teardown(channel->rpc.unpacker);
+  xfree(channel->rpc.unpacker);
 
   // Unsubscribe from all events
   char *event_string;
@@ -572,21 +699,26 @@ void rpc_free(Channel *channel)
 
   pmap_destroy(cstr_t)(channel->rpc.subscribed_events);
   kv_destroy(channel->rpc.call_stack);
+  kv_destroy(channel->rpc.stats.methods);
+  if (channel->rpc.shm) {
+    shm_free(channel->rpc.shm);
+  }
   api_free_dictionary(channel->rpc.info);
 }
 
-static bool is_rpc_response(msgpack_object *obj)
+static bool is_rpc_response(Object *obj)
 {
-  return obj->type == MSGPACK_OBJECT_ARRAY
-         && obj->via.array.size == 4
-         && obj->via.array.ptr[0].type == MSGPACK_OBJECT_POSITIVE_INTEGER
-         && obj->via.array.ptr[0].via.u64 == 1
-         && obj->via.array.ptr[1].type == MSGPACK_OBJECT_POSITIVE_INTEGER;
+  return obj->type == kObjectTypeArray
+         && obj->data.array.size == 4
+         && obj->data.array.items[0].type == kObjectTypeInteger
+         && obj->data.array.items[0].data.integer == 1
+         && obj->data.array.items[1].type == kObjectTypeInteger
+         && obj->data.array.items[1].data.integer >= 0;
 }
 
-static bool is_valid_rpc_response(msgpack_object *obj, Channel *channel)
+static bool is_valid_rpc_response(Object *obj, Channel *channel)
 {
-  uint32_t response_id = (uint32_t)obj->via.array.ptr[1].via.u64;
+  uint32_t response_id = (uint32_t)obj->data.array.items[1].data.integer;
   if (kv_size(channel->rpc.call_stack) == 0) {
     return false;
   }
@@ -596,17 +728,14 @@ static bool is_valid_rpc_response(msgpack_object *obj, Channel *channel)
   return response_id == frame->request_id;
 }
 
-static void complete_call(msgpack_object *obj, Channel *channel)
+static void complete_call(Object *obj, Channel *channel)
 {
   ChannelCallFrame *frame = kv_last(channel->rpc.call_stack);
   frame->returned = true;
-  frame->errored = obj->via.array.ptr[2].type != MSGPACK_OBJECT_NIL;
+  frame->errored = obj->data.array.items[2].type != kObjectTypeNil;
 
-  if (frame->errored) {
-    msgpack_rpc_to_object(&obj->via.array.ptr[2], &frame->result);
-  } else {
-    msgpack_rpc_to_object(&obj->via.array.ptr[3], &frame->result);
-  }
+  // The response is freed with its arena, copy the result.
+  frame->result = copy_object(obj->data.array.items[frame->errored ? 2 : 3]);
 }
 
 static void call_set_error(Channel *channel, char *msg, int loglevel)
@@ -624,44 +753,54 @@ static void call_set_error(Channel *channel, char *msg, int loglevel)
 }
 
 static WBuffer *serialize_request(uint64_t channel_id, uint32_t request_id, const String method,
-                                  Array args, msgpack_sbuffer *sbuffer, size_t refcount)
+                                  Array args, size_t refcount)
 {
-  msgpack_packer pac;
-  msgpack_packer_init(&pac, sbuffer, msgpack_sbuffer_write);
-  msgpack_rpc_serialize_request(request_id, method, args, &pac);
-  log_server_msg(channel_id, sbuffer);
-  WBuffer *rv = wstream_new_buffer(xmemdup(sbuffer->data, sbuffer->size),
-                                   sbuffer->size,
-                                   refcount,
-                                   xfree);
-  msgpack_sbuffer_clear(sbuffer);
+  PackerBuffer b = PACKER_BUFFER_INIT;
+  msgpack_rpc_serialize_request(request_id, method, args, &b);
   api_free_array(args);
-  return rv;
+  return packed_wbuffer(channel_id, &b, refcount);
 }
 
 static WBuffer *serialize_response(uint64_t channel_id, MessageType type, uint32_t response_id,
-                                   Error *err, Object arg, msgpack_sbuffer *sbuffer)
+                                   Error *err, Object arg)
 {
-  msgpack_packer pac;
-  msgpack_packer_init(&pac, sbuffer, msgpack_sbuffer_write);
+  PackerBuffer b = PACKER_BUFFER_INIT;
   if (ERROR_SET(err) && type == kMessageTypeNotification) {
     Array args = ARRAY_DICT_INIT;
     ADD(args, INTEGER_OBJ(err->type));
     ADD(args, STRING_OBJ(cstr_to_string(err->msg)));
     msgpack_rpc_serialize_request(0, cstr_as_string("nvim_error_event"),
-                                  args, &pac);
+                                  args, &b);
     api_free_array(args);
   } else {
-    msgpack_rpc_serialize_response(response_id, err, arg, &pac);
-  }
-  log_server_msg(channel_id, sbuffer);
-  WBuffer *rv = wstream_new_buffer(xmemdup(sbuffer->data, sbuffer->size),
-                                   sbuffer->size,
-                                   1,  // responses only go though 1 channel
-                                   xfree);
-  msgpack_sbuffer_clear(sbuffer);
-  api_free_object(arg);
-  return rv;
+    msgpack_rpc_serialize_response(response_id, err, arg, &b);
+  }
+  // responses only go though 1 channel
+  return packed_wbuffer(channel_id, &b, 1);
+}
+
+/// Hands the message written to `b` over to a new WBuffer, without copying.
+static WBuffer *packed_wbuffer(uint64_t channel_id, PackerBuffer *b, size_t refcount)
+{
+  size_t size;
+  char *data = packer_take(b, &size);
+  log_server_msg(channel_id, data, size);
+  return wstream_new_buffer(data, size, refcount, xfree);
+}
+
+/// Sends a notification already serialized with the functions of packer.h,
+/// like the "redraw" events of a remote UI.
+///
+/// @param b  Buffer with the message, reset by this function.
+/// @return false if the channel is not an open RPC channel.
+bool rpc_send_packed(uint64_t id, PackerBuffer *b)
+{
+  Channel *channel = find_rpc_channel(id);
+  if (!channel) {
+    packer_free(b);
+    return false;
+  }
+  return channel_write(channel, packed_wbuffer(id, b, 1));
 }
 
 void rpc_set_client_info(uint64_t id, Dictionary info)
@@ -681,6 +820,80 @@ Dictionary rpc_client_info(Channel *chan)
   return copy_dictionary(chan->rpc.info);
 }
 
+/// Gets the counters of method `handler`, allocated on first use.
+static RpcMethodStats *rpc_method_stats(Channel *channel, MsgpackRpcRequestHandler handler)
+{
+  RpcStats *stats = &channel->rpc.stats;
+  size_t size = kv_size(stats->methods);
+  if (handler.id >= size) {
+    kv_resize(stats->methods, handler.id + 1);
+    memset(&kv_A(stats->methods, size), 0, (handler.id + 1 - size) * sizeof(RpcMethodStats));
+    kv_size(stats->methods) = handler.id + 1;
+  }
+  RpcMethodStats *rv = &kv_A(stats->methods, handler.id);
+  rv->name = handler.name;
+  return rv;
+}
+
+/// Gets the bucket of the latency histograms, see RPC_LATENCY_BUCKETS.
+static size_t rpc_latency_bucket(uint64_t ns)
+{
+  size_t bucket = 0;
+  for (uint64_t us = ns / 1000; us && bucket < RPC_LATENCY_BUCKETS - 1; us >>= 1) {
+    bucket++;
+  }
+  return bucket;
+}
+
+/// Converts a latency histogram, without the empty buckets at the end.
+static Array rpc_latency_hist(const uint32_t *hist)
+{
+  size_t size = RPC_LATENCY_BUCKETS;
+  while (size && !hist[size - 1]) {
+    size--;
+  }
+  Array rv = ARRAY_DICT_INIT;
+  for (size_t i = 0; i < size; i++) {
+    ADD(rv, INTEGER_OBJ((Integer)hist[i]));
+  }
+  return rv;
+}
+
+/// Gets the performance counters of an RPC channel, see nvim_get_chan_info().
+Dictionary rpc_stats(Channel *chan)
+{
+  RpcStats *stats = &chan->rpc.stats;
+  Dictionary rv = ARRAY_DICT_INIT;
+  PUT(rv, "requests", INTEGER_OBJ((Integer)stats->requests));
+  PUT(rv, "notifications", INTEGER_OBJ((Integer)stats->notifications));
+  PUT(rv, "responses", INTEGER_OBJ((Integer)stats->responses));
+  PUT(rv, "bytes_in", INTEGER_OBJ((Integer)stats->bytes_in));
+  PUT(rv, "bytes_out", INTEGER_OBJ((Integer)stats->bytes_out));
+  PUT(rv, "writes", INTEGER_OBJ(chan->streamtype == kChannelStreamInternal
+                                ? 0 : (Integer)channel_instream(chan)->num_writes));
+  PUT(rv, "shm", BOOLEAN_OBJ(chan->streamtype != kChannelStreamInternal
+                             && channel_instream(chan)->shm != NULL));
+  PUT(rv, "queue", INTEGER_OBJ((Integer)multiqueue_size(chan->events)));
+  PUT(rv, "queue_max", INTEGER_OBJ((Integer)stats->queue_max));
+
+  Dictionary methods = ARRAY_DICT_INIT;
+  for (size_t i = 0; i < kv_size(stats->methods); i++) {
+    RpcMethodStats *m = &kv_A(stats->methods, i);
+    if (!m->name) {
+      continue;
+    }
+    Dictionary method = ARRAY_DICT_INIT;
+    PUT(method, "calls", INTEGER_OBJ((Integer)m->calls));
+    PUT(method, "errors", INTEGER_OBJ((Integer)m->errors));
+    PUT(method, "time", INTEGER_OBJ((Integer)m->handle_ns));
+    PUT(method, "handle_hist", ARRAY_OBJ(rpc_latency_hist(m->handle_hist)));
+    PUT(method, "response_hist", ARRAY_OBJ(rpc_latency_hist(m->response_hist)));
+    PUT(methods, m->name, DICTIONARY_OBJ(method));
+  }
+  PUT(rv, "methods", DICTIONARY_OBJ(methods));
+  return rv;
+}
+
 const char *rpc_client_name(Channel *chan)
 {
   if (!chan->is_rpc) {
@@ -714,13 +927,13 @@ static const char *const msgpack_error_messages[] = {
   [MSGPACK_UNPACK_NOMEM_ERROR + MUR_OFF] = "not enough memory",
 };
 
-static void log_server_msg(uint64_t channel_id, msgpack_sbuffer *packed)
+static void log_server_msg(uint64_t channel_id, const char *data, size_t size)
 {
   msgpack_unpacked unpacked;
   msgpack_unpacked_init(&unpacked);
   DLOGN("RPC ->ch %" PRIu64 ": ", channel_id);
   const msgpack_unpack_return result =
-    msgpack_unpack_next(&unpacked, packed->data, packed->size, NULL);
+    msgpack_unpack_next(&unpacked, data, size, NULL);
   switch (result) {
   case MSGPACK_UNPACK_SUCCESS: {
     uint64_t type = unpacked.data.via.array.ptr[0].via.u64;
@@ -750,13 +963,25 @@ static void log_server_msg(uint64_t channel_id, msgpack_sbuffer *packed)
   }
 }
 
-static void log_client_msg(uint64_t channel_id, bool is_request, msgpack_object msg)
+static void log_client_msg(uint64_t channel_id, bool is_request, Object msg)
 {
+  // Pack the message again, to print it like the messages sent.
+  msgpack_sbuffer sbuffer;
+  msgpack_sbuffer_init(&sbuffer);
+  msgpack_packer pac;
+  msgpack_packer_init(&pac, &sbuffer, msgpack_sbuffer_write);
+  msgpack_rpc_from_object(msg, &pac);
+  msgpack_unpacked unpacked;
+  msgpack_unpacked_init(&unpacked);
+  msgpack_unpack_next(&unpacked, sbuffer.data, sbuffer.size, NULL);
+
   DLOGN("RPC <-ch %" PRIu64 ": ", channel_id);
   log_lock();
   FILE *f = open_log_file();
   fprintf(f, is_request ? REQ : RES);
-  log_msg_close(f, msg);
+  log_msg_close(f, unpacked.data);
+  msgpack_unpacked_destroy(&unpacked);
+  msgpack_sbuffer_destroy(&sbuffer);
 }
 
 static void log_msg_close(FILE *f, msgpack_object msg)
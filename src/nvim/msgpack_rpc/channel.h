@@ -8,6 +8,7 @@
 #include "nvim/channel.h"
 #include "nvim/event/process.h"
 #include "nvim/event/socket.h"
+#include "nvim/msgpack_rpc/packer.h"
 #include "nvim/vim.h"
 
 #define METHOD_MAXLEN 512
@@ -8,6 +8,7 @@
 #include "nvim/api/private/defs.h"
 #include "nvim/event/process.h"
 #include "nvim/event/socket.h"
+#include "nvim/msgpack_rpc/unpacker.h"
 #include "nvim/vim.h"
 
 typedef struct Channel Channel;
@@ -23,16 +24,42 @@ typedef struct {
   Channel *channel;
   MsgpackRpcRequestHandler handler;
   Array args;
+  ArenaMem used_mem;  ///< Memory of `args`, see unpacker_take().
   uint32_t request_id;
+  uint64_t received;  ///< os_hrtime() when the message was parsed.
 } RequestEvent;
 
+/// Buckets of the latency histograms. Bucket `i` counts latencies below
+/// 2^i microseconds, the last one all that are longer.
+#define RPC_LATENCY_BUCKETS 24
+
+typedef struct {
+  const char *name;   ///< NULL if the method was not called.
+  uint64_t calls;     ///< Requests and notifications.
+  uint64_t errors;
+  uint64_t handle_ns;  ///< Total time spent in the method.
+  uint32_t handle_hist[RPC_LATENCY_BUCKETS];    ///< Time in the method.
+  uint32_t response_hist[RPC_LATENCY_BUCKETS];  ///< Time until the response
+                                                ///< was written, requests only.
+} RpcMethodStats;
+
+typedef struct {
+  uint64_t requests, notifications;
+  uint64_t responses;   ///< Responses to requests sent by Nvim.
+  uint64_t bytes_in, bytes_out;
+  size_t queue_max;     ///< Most events queued at once.
+  kvec_t(RpcMethodStats) methods;  ///< Indexed by MsgpackRpcRequestHandler.id.
+} RpcStats;
+
 typedef struct {
   PMap(cstr_t) subscribed_events[1];
   bool closed;
-  msgpack_unpacker *unpacker;
+  Unpacker *unpacker;
   uint32_t next_request_id;
   kvec_t(ChannelCallFrame *) call_stack;
   Dictionary info;
+  ShmTransport *shm;  ///< Not started yet, see rpc_shm_attach().
+  RpcStats stats;
 } RpcState;
 
 #endif  // NVIM_MSGPACK_RPC_CHANNEL_DEFS_H
@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <msgpack.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "nvim/api/private/dispatch.h"
 #include "nvim/api/private/helpers.h"
@@ -12,6 +13,7 @@
 #include "nvim/log.h"
 #include "nvim/memory.h"
 #include "nvim/msgpack_rpc/helpers.h"
+#include "nvim/msgpack_rpc/packer.h"
 #include "nvim/vim.h"
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
@@ -433,112 +435,112 @@ void msgpack_rpc_from_dictionary(Dictionary result, msgpack_packer *res)
 
 /// Serializes a msgpack-rpc request or notification(id == 0)
 void msgpack_rpc_serialize_request(uint32_t request_id, const String method, Array args,
-                                   msgpack_packer *pac)
+                                   PackerBuffer *b)
   FUNC_ATTR_NONNULL_ARG(4)
 {
-  msgpack_pack_array(pac, request_id ? 4 : 3);
-  msgpack_pack_int(pac, request_id ? 0 : 2);
+  packer_array(b, request_id ? 4 : 3);
+  packer_integer(b, request_id ? 0 : 2);
 
   if (request_id) {
-    msgpack_pack_uint32(pac, request_id);
+    packer_integer(b, request_id);
   }
 
-  msgpack_rpc_from_string(method, pac);
-  msgpack_rpc_from_array(args, pac);
+  packer_str(b, method.data, method.size);
+  packer_array_items(b, args);
 }
 
 /// Serializes a msgpack-rpc response
 void msgpack_rpc_serialize_response(uint32_t response_id, Error *err, Object arg,
-                                    msgpack_packer *pac)
+                                    PackerBuffer *b)
   FUNC_ATTR_NONNULL_ARG(2, 4)
 {
-  msgpack_pack_array(pac, 4);
-  msgpack_pack_int(pac, 1);
-  msgpack_pack_uint32(pac, response_id);
+  packer_array(b, 4);
+  packer_integer(b, 1);
+  packer_integer(b, response_id);
 
   if (ERROR_SET(err)) {
     // error represented by a [type, message] array
-    msgpack_pack_array(pac, 2);
-    msgpack_rpc_from_integer(err->type, pac);
-    msgpack_rpc_from_string(cstr_as_string(err->msg), pac);
+    packer_array(b, 2);
+    packer_integer(b, err->type);
+    packer_str(b, err->msg, strlen(err->msg));
     // Nil result
-    msgpack_pack_nil(pac);
+    packer_nil(b);
   } else {
     // Nil error
-    msgpack_pack_nil(pac);
+    packer_nil(b);
     // Return value
-    msgpack_rpc_from_object(arg, pac);
+    packer_object(b, &arg);
   }
 }
 
-static bool msgpack_rpc_is_notification(msgpack_object *req)
+static bool msgpack_rpc_is_notification(Object *req)
 {
-  return req->via.array.ptr[0].via.u64 == 2;
+  return req->data.array.items[0].data.integer == 2;
 }
 
-msgpack_object *msgpack_rpc_method(msgpack_object *req)
+String *msgpack_rpc_method(Object *req)
 {
-  msgpack_object *obj = req->via.array.ptr
-                        + (msgpack_rpc_is_notification(req) ? 1 : 2);
-  return obj->type == MSGPACK_OBJECT_STR || obj->type == MSGPACK_OBJECT_BIN ?
-         obj : NULL;
+  Object *obj = req->data.array.items
+                + (msgpack_rpc_is_notification(req) ? 1 : 2);
+  return obj->type == kObjectTypeString ? &obj->data.string : NULL;
 }
 
-msgpack_object *msgpack_rpc_args(msgpack_object *req)
+Array *msgpack_rpc_args(Object *req)
 {
-  msgpack_object *obj = req->via.array.ptr
-                        + (msgpack_rpc_is_notification(req) ? 2 : 3);
-  return obj->type == MSGPACK_OBJECT_ARRAY ? obj : NULL;
+  Object *obj = req->data.array.items
+                + (msgpack_rpc_is_notification(req) ? 2 : 3);
+  return obj->type == kObjectTypeArray ? &obj->data.array : NULL;
 }
 
-static msgpack_object *msgpack_rpc_msg_id(msgpack_object *req)
+static Object *msgpack_rpc_msg_id(Object *req)
 {
   if (msgpack_rpc_is_notification(req)) {
     return NULL;
   }
-  msgpack_object *obj = &req->via.array.ptr[1];
-  return obj->type == MSGPACK_OBJECT_POSITIVE_INTEGER ? obj : NULL;
+  Object *obj = &req->data.array.items[1];
+  return obj->type == kObjectTypeInteger && obj->data.integer >= 0 ? obj : NULL;
 }
 
-MessageType msgpack_rpc_validate(uint32_t *response_id, msgpack_object *req, Error *err)
+MessageType msgpack_rpc_validate(uint32_t *response_id, Object *req, Error *err)
 {
   *response_id = 0;
   // Validate the basic structure of the msgpack-rpc payload
-  if (req->type != MSGPACK_OBJECT_ARRAY) {
+  if (req->type != kObjectTypeArray) {
     api_set_error(err, kErrorTypeValidation, "Message is not an array");
     return kMessageTypeUnknown;
   }
 
-  if (req->via.array.size == 0) {
+  if (req->data.array.size == 0) {
     api_set_error(err, kErrorTypeValidation, "Message is empty");
     return kMessageTypeUnknown;
   }
 
-  if (req->via.array.ptr[0].type != MSGPACK_OBJECT_POSITIVE_INTEGER) {
+  if (req->data.array.items[0].type != kObjectTypeInteger
+      || req->data.array.items[0].data.integer < 0) {
     api_set_error(err, kErrorTypeValidation, "Message type must be an integer");
     return kMessageTypeUnknown;
   }
 
-  MessageType type = (MessageType)req->via.array.ptr[0].via.u64;
+  MessageType type = (MessageType)req->data.array.items[0].data.integer;
   if (type != kMessageTypeRequest && type != kMessageTypeNotification) {
     api_set_error(err, kErrorTypeValidation, "Unknown message type");
     return kMessageTypeUnknown;
   }
 
-  if ((type == kMessageTypeRequest && req->via.array.size != 4)
-      || (type == kMessageTypeNotification && req->via.array.size != 3)) {
+  if ((type == kMessageTypeRequest && req->data.array.size != 4)
+      || (type == kMessageTypeNotification && req->data.array.size != 3)) {
     api_set_error(err, kErrorTypeValidation,
                   "Request array size must be 4 (request) or 3 (notification)");
     return type;
   }
 
   if (type == kMessageTypeRequest) {
-    msgpack_object *id_obj = msgpack_rpc_msg_id(req);
+    Object *id_obj = msgpack_rpc_msg_id(req);
     if (!id_obj) {
       api_set_error(err, kErrorTypeValidation, "ID must be a positive integer");
       return type;
     }
-    *response_id = (uint32_t)id_obj->via.u64;
+    *response_id = (uint32_t)id_obj->data.integer;
   }
 
   if (!msgpack_rpc_method(req)) {
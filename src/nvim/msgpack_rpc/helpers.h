@@ -7,6 +7,7 @@
 
 #include "nvim/api/private/defs.h"
 #include "nvim/event/wstream.h"
+#include "nvim/msgpack_rpc/packer.h"
 
 /// Value by which objects represented as EXT type are shifted
 ///
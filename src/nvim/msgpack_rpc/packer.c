@@ -0,0 +1,287 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nvim/api/private/defs.h"
+#include "nvim/lib/kvec.h"
+#include "nvim/macros.h"
+#include "nvim/memory.h"
+#include "nvim/msgpack_rpc/helpers.h"
+#include "nvim/msgpack_rpc/packer.h"
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "msgpack_rpc/packer.c.generated.h"
+#endif
+
+/// Initial size of a buffer, enough for most responses.
+#define PACKER_INITIAL_SIZE 256
+
+/// Makes room for `size` more bytes, see packer_reserve().
+void packer_grow(PackerBuffer *b, size_t size)
+  FUNC_ATTR_NONNULL_ALL
+{
+  size_t used = packer_size(b);
+  size_t capacity = (size_t)(b->endptr - b->startptr);
+  size_t new_capacity = MAX(capacity, PACKER_INITIAL_SIZE);
+  while (new_capacity - used < size) {
+    new_capacity *= 2;
+  }
+  b->startptr = xrealloc(b->startptr, new_capacity);
+  b->ptr = b->startptr + used;
+  b->endptr = b->startptr + new_capacity;
+}
+
+/// Takes the written bytes, the buffer is reset to write the next message.
+///
+/// @param[out]  size  Number of bytes.
+/// @return Allocated data, free it with xfree(), or NULL if nothing was written.
+char *packer_take(PackerBuffer *b, size_t *size)
+  FUNC_ATTR_NONNULL_ALL
+{
+  char *rv = b->startptr;
+  *size = packer_size(b);
+  *b = (PackerBuffer)PACKER_BUFFER_INIT;
+  return rv;
+}
+
+/// Frees the buffer, discarding the written bytes.
+void packer_free(PackerBuffer *b)
+  FUNC_ATTR_NONNULL_ALL
+{
+  xfree(b->startptr);
+  *b = (PackerBuffer)PACKER_BUFFER_INIT;
+}
+
+/// Writes a str16/32, array16/32 or map16/32 header. `tag` is the 16-bit
+/// variant, the 32-bit one follows it.
+void packer_header(PackerBuffer *b, uint8_t tag, size_t size)
+  FUNC_ATTR_NONNULL_ALL
+{
+  assert(size <= UINT32_MAX);
+  if (size < 0x10000) {
+    packer_w1(b, tag);
+    packer_w2(b->ptr, (uint16_t)size);
+    b->ptr += 2;
+  } else {
+    packer_w1(b, (uint8_t)(tag + 1));
+    packer_w4(b->ptr, (uint32_t)size);
+    b->ptr += 4;
+  }
+}
+
+/// Writes an array header whose size is not known yet.
+///
+/// @return Offset to pass to packer_array_patch() once the size is known.
+size_t packer_array_placeholder(PackerBuffer *b)
+  FUNC_ATTR_NONNULL_ALL
+{
+  packer_reserve(b, PACKER_HEADER_MAX);
+  packer_w1(b, 0xdd);
+  size_t pos = packer_size(b);
+  b->ptr += 4;
+  return pos;
+}
+
+void packer_array_patch(PackerBuffer *b, size_t pos, uint32_t size)
+  FUNC_ATTR_NONNULL_ALL
+{
+  assert(pos + 4 <= packer_size(b));
+  packer_w4(b->startptr + pos, size);
+}
+
+/// Writes an integer, in the smallest encoding like msgpack-c does.
+void packer_integer_slow(PackerBuffer *b, Integer v)
+  FUNC_ATTR_NONNULL_ALL
+{
+  if (v >= 0) {
+    uint64_t u = (uint64_t)v;
+    if (u < 0x80) {
+      packer_w1(b, (uint8_t)u);
+    } else if (u < 0x100) {
+      packer_w1(b, 0xcc);
+      packer_w1(b, (uint8_t)u);
+    } else if (u < 0x10000) {
+      packer_w1(b, 0xcd);
+      packer_w2(b->ptr, (uint16_t)u);
+      b->ptr += 2;
+    } else if (u < 0x100000000) {
+      packer_w1(b, 0xce);
+      packer_w4(b->ptr, (uint32_t)u);
+      b->ptr += 4;
+    } else {
+      packer_w1(b, 0xcf);
+      packer_w4(b->ptr, (uint32_t)(u >> 32));
+      packer_w4(b->ptr + 4, (uint32_t)u);
+      b->ptr += 8;
+    }
+  } else if (v >= -0x20) {
+    packer_w1(b, (uint8_t)(0xe0 | (v + 0x20)));
+  } else if (v >= INT8_MIN) {
+    packer_w1(b, 0xd0);
+    packer_w1(b, (uint8_t)(int8_t)v);
+  } else if (v >= INT16_MIN) {
+    packer_w1(b, 0xd1);
+    packer_w2(b->ptr, (uint16_t)(int16_t)v);
+    b->ptr += 2;
+  } else if (v >= INT32_MIN) {
+    packer_w1(b, 0xd2);
+    packer_w4(b->ptr, (uint32_t)(int32_t)v);
+    b->ptr += 4;
+  } else {
+    uint64_t u = (uint64_t)v;
+    packer_w1(b, 0xd3);
+    packer_w4(b->ptr, (uint32_t)(u >> 32));
+    packer_w4(b->ptr + 4, (uint32_t)u);
+    b->ptr += 8;
+  }
+}
+
+void packer_float(PackerBuffer *b, Float v)
+  FUNC_ATTR_NONNULL_ALL
+{
+  uint64_t u;
+  memcpy(&u, &v, sizeof(u));
+  packer_reserve(b, 9);
+  packer_w1(b, 0xcb);
+  packer_w4(b->ptr, (uint32_t)(u >> 32));
+  packer_w4(b->ptr + 4, (uint32_t)u);
+  b->ptr += 8;
+}
+
+/// Writes a buffer, window or tabpage handle as EXT object.
+void packer_handle(PackerBuffer *b, ObjectType type, Integer handle)
+  FUNC_ATTR_NONNULL_ALL
+{
+  // The payload is the handle as msgpack integer.
+  char payload[PACKER_INTEGER_MAX];
+  PackerBuffer pb = { .startptr = payload, .ptr = payload,
+                      .endptr = payload + sizeof(payload) };
+  packer_integer(&pb, (handle_T)handle);
+  size_t size = packer_size(&pb);
+
+  packer_reserve(b, 3 + size);
+  switch (size) {
+  case 1:
+    packer_w1(b, 0xd4);
+    break;
+  case 2:
+    packer_w1(b, 0xd5);
+    break;
+  case 4:
+    packer_w1(b, 0xd6);
+    break;
+  case 8:
+    packer_w1(b, 0xd7);
+    break;
+  default:
+    packer_w1(b, 0xc7);
+    packer_w1(b, (uint8_t)size);
+    break;
+  }
+  packer_w1(b, (uint8_t)(type - EXT_OBJECT_TYPE_SHIFT));
+  memcpy(b->ptr, payload, size);
+  b->ptr += size;
+}
+
+typedef struct {
+  const Object *aobj;
+  bool container;
+  size_t idx;
+} PackerStackItem;
+
+/// Writes an API object, see msgpack_rpc_from_object() for the msgpack-c
+/// variant.
+void packer_object(PackerBuffer *b, const Object *obj)
+  FUNC_ATTR_NONNULL_ALL
+{
+  kvec_withinit_t(PackerStackItem, 2) stack = KV_INITIAL_VALUE;
+  kvi_init(stack);
+  kvi_push(stack, ((PackerStackItem) { obj, false, 0 }));
+  while (kv_size(stack)) {
+    PackerStackItem cur = kv_last(stack);
+    switch (cur.aobj->type) {
+    case kObjectTypeNil:
+    case kObjectTypeLuaRef:
+      packer_nil(b);
+      break;
+    case kObjectTypeBoolean:
+      packer_bool(b, cur.aobj->data.boolean);
+      break;
+    case kObjectTypeInteger:
+      packer_integer(b, cur.aobj->data.integer);
+      break;
+    case kObjectTypeFloat:
+      packer_float(b, cur.aobj->data.floating);
+      break;
+    case kObjectTypeString:
+      packer_str(b, cur.aobj->data.string.data, cur.aobj->data.string.size);
+      break;
+    case kObjectTypeBuffer:
+    case kObjectTypeWindow:
+    case kObjectTypeTabpage:
+      packer_handle(b, cur.aobj->type, cur.aobj->data.integer);
+      break;
+    case kObjectTypeArray: {
+      const size_t size = cur.aobj->data.array.size;
+      if (cur.container) {
+        if (cur.idx >= size) {
+          (void)kv_pop(stack);
+        } else {
+          const size_t idx = cur.idx;
+          cur.idx++;
+          kv_last(stack) = cur;
+          kvi_push(stack, ((PackerStackItem) {
+              .aobj = &cur.aobj->data.array.items[idx],
+              .container = false,
+            }));
+        }
+      } else {
+        packer_array(b, size);
+        cur.container = true;
+        kv_last(stack) = cur;
+      }
+      break;
+    }
+    case kObjectTypeDictionary: {
+      const size_t size = cur.aobj->data.dictionary.size;
+      if (cur.container) {
+        if (cur.idx >= size) {
+          (void)kv_pop(stack);
+        } else {
+          const size_t idx = cur.idx;
+          cur.idx++;
+          kv_last(stack) = cur;
+          const String key = cur.aobj->data.dictionary.items[idx].key;
+          packer_str(b, key.data, key.size);
+          kvi_push(stack, ((PackerStackItem) {
+              .aobj = &cur.aobj->data.dictionary.items[idx].value,
+              .container = false,
+            }));
+        }
+      } else {
+        packer_map(b, size);
+        cur.container = true;
+        kv_last(stack) = cur;
+      }
+      break;
+    }
+    }
+    if (!cur.container) {
+      (void)kv_pop(stack);
+    }
+  }
+  kvi_destroy(stack);
+}
+
+void packer_array_items(PackerBuffer *b, Array arr)
+  FUNC_ATTR_NONNULL_ALL
+{
+  packer_array(b, arr.size);
+  for (size_t i = 0; i < arr.size; i++) {
+    packer_object(b, &arr.items[i]);
+  }
+}
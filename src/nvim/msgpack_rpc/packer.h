@@ -0,0 +1,143 @@
+#ifndef NVIM_MSGPACK_RPC_PACKER_H
+#define NVIM_MSGPACK_RPC_PACKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nvim/api/private/defs.h"
+#include "nvim/func_attr.h"
+
+/// Growable buffer msgpack is written to, without intermediate objects.
+///
+/// Writers first reserve the most bytes a value can take with
+/// packer_reserve(), the value is then written without further checks. The
+/// result is one contiguous buffer, which can be handed to a WBuffer as is.
+typedef struct {
+  char *startptr;
+  char *ptr;
+  char *endptr;
+} PackerBuffer;
+
+#define PACKER_BUFFER_INIT { .startptr = NULL, .ptr = NULL, .endptr = NULL }
+
+/// Most bytes taken by the header of a str, array or map.
+#define PACKER_HEADER_MAX 5
+/// Most bytes taken by an integer.
+#define PACKER_INTEGER_MAX 9
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "msgpack_rpc/packer.h.generated.h"
+#endif
+
+/// Makes room for `size` more bytes.
+static inline void packer_reserve(PackerBuffer *const b, const size_t size)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  if ((size_t)(b->endptr - b->ptr) < size) {
+    packer_grow(b, size);
+  }
+}
+
+/// Bytes written so far.
+static inline size_t packer_size(const PackerBuffer *const b)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PURE
+{
+  return (size_t)(b->ptr - b->startptr);
+}
+
+// The functions below write without checking for room, see packer_reserve().
+
+static inline void packer_w1(PackerBuffer *const b, const uint8_t v)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  *b->ptr++ = (char)v;
+}
+
+static inline void packer_w2(char *const p, const uint16_t v)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  p[0] = (char)(v >> 8);
+  p[1] = (char)v;
+}
+
+/// Writes a big-endian 32-bit value, also used to patch placeholders, see
+/// packer_array_placeholder().
+static inline void packer_w4(char *const p, const uint32_t v)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  p[0] = (char)(v >> 24);
+  p[1] = (char)(v >> 16);
+  p[2] = (char)(v >> 8);
+  p[3] = (char)v;
+}
+
+static inline void packer_nil(PackerBuffer *const b)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  packer_reserve(b, 1);
+  packer_w1(b, 0xc0);
+}
+
+static inline void packer_bool(PackerBuffer *const b, const bool v)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  packer_reserve(b, 1);
+  packer_w1(b, v ? 0xc3 : 0xc2);
+}
+
+/// Writes the header of an array of `size` items.
+static inline void packer_array(PackerBuffer *const b, const size_t size)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  packer_reserve(b, PACKER_HEADER_MAX);
+  if (size < 0x10) {
+    packer_w1(b, (uint8_t)(0x90 | size));
+  } else {
+    packer_header(b, 0xdc, size);
+  }
+}
+
+/// Writes the header of a map of `size` key/value pairs.
+static inline void packer_map(PackerBuffer *const b, const size_t size)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  packer_reserve(b, PACKER_HEADER_MAX);
+  if (size < 0x10) {
+    packer_w1(b, (uint8_t)(0x80 | size));
+  } else {
+    packer_header(b, 0xde, size);
+  }
+}
+
+static inline void packer_str(PackerBuffer *const b, const char *const data, const size_t size)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ARG(1)
+{
+  packer_reserve(b, PACKER_HEADER_MAX + size);
+  if (size < 0x20) {
+    packer_w1(b, (uint8_t)(0xa0 | size));
+  } else if (size < 0x100) {
+    packer_w1(b, 0xd9);
+    packer_w1(b, (uint8_t)size);
+  } else {
+    packer_header(b, 0xda, size);
+  }
+  if (size) {
+    memcpy(b->ptr, data, size);
+    b->ptr += size;
+  }
+}
+
+static inline void packer_integer(PackerBuffer *const b, const Integer v)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  packer_reserve(b, PACKER_INTEGER_MAX);
+  if (v >= 0 && v < 0x80) {
+    packer_w1(b, (uint8_t)v);
+  } else {
+    packer_integer_slow(b, v);
+  }
+}
+
+#endif  // NVIM_MSGPACK_RPC_PACKER_H
@@ -0,0 +1,308 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpack/conv.h"
+#include "nvim/api/private/helpers.h"
+#include "nvim/memory.h"
+#include "nvim/msgpack_rpc/helpers.h"
+#include "nvim/msgpack_rpc/unpacker.h"
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "msgpack_rpc/unpacker.c.generated.h"
+#endif
+
+void unpacker_init(Unpacker *p)
+  FUNC_ATTR_NONNULL_ALL
+{
+  mpack_tokbuf_init(&p->reader);
+  p->arena = (Arena)ARENA_EMPTY;
+  p->result = NIL;
+  kv_init(p->stack);
+  p->chunk_dest = NULL;
+  p->chunk_left = 0;
+  p->ext = NULL;
+  p->ext_size = 0;
+  p->invalid = false;
+  p->done = false;
+}
+
+void unpacker_teardown(Unpacker *p)
+  FUNC_ATTR_NONNULL_ALL
+{
+  arena_mem_free(arena_finish(&p->arena));
+  kv_destroy(p->stack);
+}
+
+/// Unpacks from `*data`, advancing it and `*size` past the consumed input.
+///
+/// Input belonging to an incomplete token is saved, so the caller does not
+/// need to keep it around.
+///
+/// @return kUnpackerDone when an object is complete, it must be taken with
+///         unpacker_take() before advancing further.
+UnpackerStatus unpacker_advance(Unpacker *p, const char **data, size_t *size)
+  FUNC_ATTR_NONNULL_ALL
+{
+  assert(!p->done);
+  while (*size) {
+    mpack_token_t tok;
+    int status = mpack_read(&p->reader, data, size, &tok);
+    if (status == MPACK_EOF) {
+      break;
+    } else if (status == MPACK_ERROR || !unpacker_token(p, &tok)) {
+      return kUnpackerError;
+    } else if (p->done) {
+      return kUnpackerDone;
+    }
+  }
+  return kUnpackerMore;
+}
+
+/// Takes the object unpacked by unpacker_advance().
+///
+/// @param[out]  invalid  Set when some value (integers above API_INTEGER_MAX,
+///                       non-string keys, bad EXT payloads) could not be
+///                       represented, it was replaced by nil.
+/// @param[out]  mem      Memory of the object, free it with arena_mem_free()
+///                       instead of api_free_object().
+Object unpacker_take(Unpacker *p, bool *invalid, ArenaMem *mem)
+  FUNC_ATTR_NONNULL_ALL
+{
+  assert(p->done);
+  Object rv = p->result;
+  *mem = arena_finish(&p->arena);
+  *invalid = p->invalid;
+  p->result = NIL;
+  p->invalid = false;
+  p->done = false;
+  return rv;
+}
+
+/// Gets the location of the next value. For a dictionary key `*key` is set
+/// instead, and NULL is returned.
+static Object *unpacker_slot(Unpacker *p, String **key)
+{
+  *key = NULL;
+  if (!kv_size(p->stack)) {
+    return &p->result;
+  }
+  UnpackerFrame *frame = &kv_last(p->stack);
+  if (frame->obj->type == kObjectTypeArray) {
+    return &frame->obj->data.array.items[frame->idx];
+  }
+  KeyValuePair *item = &frame->obj->data.dictionary.items[frame->idx];
+  if (!frame->has_key) {
+    *key = &item->key;
+    return NULL;
+  }
+  return &item->value;
+}
+
+/// Marks the location returned by unpacker_slot() as filled, completing the
+/// containers that are full.
+static void unpacker_filled(Unpacker *p)
+{
+  while (kv_size(p->stack)) {
+    UnpackerFrame *frame = &kv_last(p->stack);
+    size_t size;
+    if (frame->obj->type == kObjectTypeArray) {
+      size = frame->obj->data.array.size;
+    } else if (!frame->has_key) {
+      frame->has_key = true;
+      return;
+    } else {
+      size = frame->obj->data.dictionary.size;
+      frame->has_key = false;
+    }
+    if (++frame->idx < size) {
+      return;
+    }
+    (void)kv_pop(p->stack);
+  }
+  p->done = true;
+}
+
+/// Allocates a NUL-terminated string of `size` bytes, filled by
+/// unpacker_chunk().
+static char *unpacker_string(Unpacker *p, size_t size)
+{
+  char *str = arena_alloc(&p->arena, size + 1, false);
+  str[size] = '\0';
+  return str;
+}
+
+/// Allocates zeroed container items, i.e. nil values.
+static void *unpacker_items(Unpacker *p, size_t size)
+{
+  void *items = arena_alloc(&p->arena, size, true);
+  memset(items, 0, size);
+  return items;
+}
+
+/// Reads the handle in the payload of an EXT object.
+static void unpacker_ext(Unpacker *p)
+{
+  Object *obj = p->ext;
+  p->ext = NULL;
+  mpack_tokbuf_t reader;
+  mpack_tokbuf_init(&reader);
+  const char *data = p->ext_data;
+  size_t size = p->ext_size;
+  mpack_token_t tok;
+  if (size <= sizeof(p->ext_data)
+      && mpack_read(&reader, &data, &size, &tok) == MPACK_OK
+      && !size && tok.type == MPACK_TOKEN_UINT) {
+    obj->data.integer = (handle_T)mpack_unpack_uint(tok);
+  } else {
+    *obj = NIL;
+    p->invalid = true;
+  }
+}
+
+static void unpacker_chunk(Unpacker *p, const mpack_token_t *tok)
+{
+  assert(tok->length <= p->chunk_left);
+  if (p->ext) {
+    if (p->ext_size + tok->length <= sizeof(p->ext_data)) {
+      memcpy(p->ext_data + p->ext_size, tok->data.chunk_ptr, tok->length);
+    }
+    p->ext_size += tok->length;
+  } else if (p->chunk_dest) {
+    memcpy(p->chunk_dest, tok->data.chunk_ptr, tok->length);
+    p->chunk_dest += tok->length;
+  }
+  p->chunk_left -= tok->length;
+  if (!p->chunk_left) {
+    if (p->ext) {
+      unpacker_ext(p);
+    }
+    p->chunk_dest = NULL;
+    unpacker_filled(p);
+  }
+}
+
+/// Reads a dictionary key, which must be a string.
+///
+/// @return false for container keys, which are not supported.
+static bool unpacker_key(Unpacker *p, String *key, const mpack_token_t *tok)
+{
+  switch (tok->type) {
+  case MPACK_TOKEN_STR:
+  case MPACK_TOKEN_BIN:
+    key->data = unpacker_string(p, tok->length);
+    key->size = tok->length;
+    p->chunk_dest = key->data;
+    break;
+  case MPACK_TOKEN_ARRAY:
+  case MPACK_TOKEN_MAP:
+    return false;
+  default:
+    // The payload of an EXT key is skipped.
+    p->invalid = true;
+    break;
+  }
+  if (tok->type >= MPACK_TOKEN_BIN && tok->length) {
+    p->chunk_left = tok->length;
+  } else {
+    p->chunk_dest = NULL;
+    unpacker_filled(p);
+  }
+  return true;
+}
+
+static bool unpacker_token(Unpacker *p, const mpack_token_t *tok)
+{
+  if (tok->type == MPACK_TOKEN_CHUNK) {
+    unpacker_chunk(p, tok);
+    return true;
+  }
+
+  String *key;
+  Object *obj = unpacker_slot(p, &key);
+  if (key) {
+    return unpacker_key(p, key, tok);
+  }
+
+  size_t size = tok->length;
+  switch (tok->type) {
+  case MPACK_TOKEN_NIL:
+    *obj = NIL;
+    break;
+  case MPACK_TOKEN_BOOLEAN:
+    *obj = BOOLEAN_OBJ(mpack_unpack_boolean(*tok));
+    break;
+  case MPACK_TOKEN_UINT: {
+    mpack_uintmax_t val = mpack_unpack_uint(*tok);
+    if (val > (mpack_uintmax_t)API_INTEGER_MAX) {
+      *obj = NIL;
+      p->invalid = true;
+    } else {
+      *obj = INTEGER_OBJ((Integer)val);
+    }
+    break;
+  }
+  case MPACK_TOKEN_SINT:
+    *obj = INTEGER_OBJ((Integer)mpack_unpack_sint(*tok));
+    break;
+  case MPACK_TOKEN_FLOAT:
+    *obj = FLOAT_OBJ(mpack_unpack_float(*tok));
+    break;
+  case MPACK_TOKEN_STR:
+  case MPACK_TOKEN_BIN:
+    *obj = STRING_OBJ(((String) { .data = unpacker_string(p, size), .size = size }));
+    if (size) {
+      p->chunk_dest = obj->data.string.data;
+      p->chunk_left = size;
+      return true;
+    }
+    break;
+  case MPACK_TOKEN_EXT:
+    *obj = NIL;
+    if (tok->data.ext_type > EXT_OBJECT_TYPE_MAX) {
+      // Unknown EXT types are nil, the payload is skipped.
+    } else if (!size) {
+      p->invalid = true;
+    } else {
+      obj->type = (ObjectType)(tok->data.ext_type + EXT_OBJECT_TYPE_SHIFT);
+      p->ext = obj;
+      p->ext_size = 0;
+    }
+    if (size) {
+      p->chunk_left = size;
+      return true;
+    }
+    break;
+  case MPACK_TOKEN_ARRAY:
+  case MPACK_TOKEN_MAP:
+    if (kv_size(p->stack) >= UNPACKER_MAX_DEPTH) {
+      return false;
+    }
+    if (tok->type == MPACK_TOKEN_ARRAY) {
+      *obj = ARRAY_OBJ(((Array) {
+        .size = size,
+        .capacity = size,
+        .items = size ? unpacker_items(p, size * sizeof(Object)) : NULL,
+      }));
+    } else {
+      *obj = DICTIONARY_OBJ(((Dictionary) {
+        .size = size,
+        .capacity = size,
+        .items = size ? unpacker_items(p, size * sizeof(KeyValuePair)) : NULL,
+      }));
+    }
+    if (size) {
+      kv_push(p->stack, ((UnpackerFrame) { .obj = obj, .idx = 0 }));
+      return true;
+    }
+    break;
+  case MPACK_TOKEN_CHUNK:
+    abort();
+  }
+  unpacker_filled(p);
+  return true;
+}
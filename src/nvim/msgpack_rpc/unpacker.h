@@ -0,0 +1,50 @@
+#ifndef NVIM_MSGPACK_RPC_UNPACKER_H
+#define NVIM_MSGPACK_RPC_UNPACKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "mpack/mpack_core.h"
+#include "nvim/api/private/defs.h"
+#include "nvim/lib/kvec.h"
+#include "nvim/memory.h"
+
+/// Maximum nesting of arrays and dictionaries in an unpacked object.
+#define UNPACKER_MAX_DEPTH 1024
+
+typedef enum {
+  kUnpackerMore = 0,  ///< All input was consumed, the object is incomplete.
+  kUnpackerDone,      ///< An object was unpacked, see unpacker_take().
+  kUnpackerError,     ///< The input is not valid msgpack.
+} UnpackerStatus;
+
+typedef struct {
+  Object *obj;   ///< Array or Dictionary being filled.
+  size_t idx;    ///< Index of the next item.
+  bool has_key;  ///< Dictionary only: the key of item `idx` was read.
+} UnpackerFrame;
+
+/// Streaming msgpack decoder producing API objects.
+///
+/// Input may be split at arbitrary points. Strings are copied from the input
+/// straight into the resulting object, without intermediate buffers. The
+/// object is allocated in an arena, and freed as a whole.
+typedef struct {
+  mpack_tokbuf_t reader;
+  Arena arena;                      ///< Memory of the object being unpacked.
+  Object result;                    ///< Object being unpacked.
+  kvec_t(UnpackerFrame) stack;      ///< Containers being filled.
+  char *chunk_dest;                 ///< Destination of str/bin data.
+  size_t chunk_left;                ///< Bytes of str/bin/ext data still due.
+  Object *ext;                      ///< EXT object whose payload is read.
+  char ext_data[MPACK_MAX_TOKEN_LEN];
+  size_t ext_size;
+  bool invalid;  ///< A value cannot be represented as API object.
+  bool done;
+} Unpacker;
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "msgpack_rpc/unpacker.h.generated.h"
+#endif
+
+#endif  // NVIM_MSGPACK_RPC_UNPACKER_H
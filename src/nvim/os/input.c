@@ -37,6 +37,7 @@ static RBuffer *input_buffer = NULL;
 static bool input_eof = false;
 static int global_fd = -1;
 static bool blocking = false;
+static bool idle = false;
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "os/input.c.generated.h"
@@ -228,6 +229,7 @@ bool os_isatty(int fd)
 
 size_t input_enqueue(String keys)
 {
+  loop_stats_input(&main_loop);
   char *ptr = keys.data;
   char *end = ptr + keys.size;
 
@@ -392,6 +394,7 @@ static unsigned int handle_mouse_event(char **ptr, uint8_t *buf, unsigned int bu
 
 size_t input_enqueue_mouse(int code, uint8_t modifier, int grid, int row, int col)
 {
+  loop_stats_input(&main_loop);
   modifier |= check_multiclick(code, grid, row, col);
   uint8_t buf[7], *p = buf;
   if (modifier) {
@@ -419,6 +422,14 @@ bool input_blocking(void)
   return blocking;
 }
 
+/// Whether the main loop waits for input or events, at a point where queued
+/// events would be processed right after. Events that only read editor state
+/// can then be handled immediately, see FUNC_API_READONLY.
+bool input_idle(void)
+{
+  return idle;
+}
+
 // This is a replacement for the old `WaitForChar` function in os_unix.c
 static InbufPollResult inbuf_poll(int ms, MultiQueue *events)
 {
@@ -435,11 +446,14 @@ static InbufPollResult inbuf_poll(int ms, MultiQueue *events)
     blocking = true;
     multiqueue_process_events(ch_before_blocking_events);
   }
+  // Queued events are processed as soon as this wait returns.
+  idle = ms != 0 && events == main_loop.events;
   DLOG("blocking... events_enabled=%d events_pending=%d", events != NULL,
        events && !multiqueue_empty(events));
   LOOP_PROCESS_EVENTS_UNTIL(&main_loop, NULL, ms,
                             input_ready(events) || input_eof);
   blocking = false;
+  idle = false;
 
   if (do_profiling == PROF_YES && ms) {
     prof_inchar_exit();
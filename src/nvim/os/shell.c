@@ -12,6 +12,7 @@
 #include "nvim/event/libuv_process.h"
 #include "nvim/event/loop.h"
 #include "nvim/event/rstream.h"
+#include "nvim/event/throttle.h"
 #include "nvim/eval.h"
 #include "nvim/ex_cmds.h"
 #include "nvim/fileio.h"
@@ -33,7 +34,6 @@
 #include "nvim/vim.h"
 
 #define DYNAMIC_BUFFER_INIT { NULL, 0, 0 }
-#define NS_1_SECOND         1000000000U     // 1 second, in nanoseconds
 #define OUT_DATA_THRESHOLD  1024 * 10U      // 10KB, "a few screenfuls" of data.
 
 #define SHELL_SPECIAL (char_u *)"\t \"&'$;<>()\\|"
@@ -43,6 +43,12 @@ typedef struct {
   size_t cap, len;
 } DynamicBuffer;
 
+typedef struct {
+  shell_output_cb cb;
+  void *data;
+  MultiQueue *events;
+} OutputStream;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "os/shell.c.generated.h"
 #endif
@@ -662,7 +668,7 @@ int os_call_shell(char_u *cmd, ShellOpts opts, char_u *extra_args)
   size_t nread;
   int exitcode = do_os_system(shell_build_argv((char *)cmd, (char *)extra_args),
                               input.data, input.len, output_ptr, &nread,
-                              emsg_silent, forward_output);
+                              emsg_silent, forward_output, NULL);
   xfree(input.data);
 
   if (output) {
@@ -816,14 +822,33 @@ done:
 int os_system(char **argv, const char *input, size_t len, char **output,
               size_t *nread) FUNC_ATTR_NONNULL_ARG(1)
 {
-  return do_os_system(argv, input, len, output, nread, true, false);
+  return do_os_system(argv, input, len, output, nread, true, false, NULL);
+}
+
+/// Like os_system(), but passes the output to `cb` chunk by chunk as it
+/// arrives, instead of gathering all of it in memory.
+///
+/// `cb` is invoked from the event queue of the process, not from a libuv
+/// callback, so it may run Vimscript. All output was passed when this returns.
+///
+/// @param argv The commandline arguments to be passed to the shell. `argv`
+///             will be consumed.
+/// @param input The input to the shell (NULL for no input).
+/// @param len The length of the input buffer (not used if `input` == NULL)
+/// @param cb Callback for the output, with stdout and stderr combined.
+/// @param data Passed to `cb`.
+/// @return the return code of the process, -1 if the process couldn't be
+///         started properly
+int os_system_stream(char **argv, const char *input, size_t len, shell_output_cb cb, void *data)
+  FUNC_ATTR_NONNULL_ARG(1, 4)
+{
+  OutputStream stream = { .cb = cb, .data = data };
+  return do_os_system(argv, input, len, NULL, NULL, true, false, &stream);
 }
 
 static int do_os_system(char **argv, const char *input, size_t len, char **output, size_t *nread,
-                        bool silent, bool forward_output)
+                        bool silent, bool forward_output, OutputStream *stream)
 {
-  out_data_decide_throttle(0);  // Initialize throttle decider.
-  out_data_ring(NULL, 0);       // Initialize output ring-buffer.
   bool has_input = (input != NULL && input[0] != '\0');
 
   // the output buffer
@@ -833,8 +858,18 @@ static int do_os_system(char **argv, const char *input, size_t len, char **outpu
     *nread = 0;
   }
 
+  // Skips output above a threshold, see out_data_pulse().
+  Throttle throttle;
+  throttle_init(&throttle, OUT_DATA_THRESHOLD);
+  throttle.pulse_cb = out_data_pulse;
+  void *data = &buf;
+
   if (forward_output) {
     data_cb = out_data_cb;
+    data = &throttle;
+  } else if (stream) {
+    data_cb = stream_data_cb;
+    data = stream;
   } else if (!output) {
     data_cb = NULL;
   }
@@ -848,6 +883,9 @@ static int do_os_system(char **argv, const char *input, size_t len, char **outpu
   MultiQueue *events = multiqueue_new_child(main_loop.events);
   proc->events = events;
   proc->argv = argv;
+  if (stream) {
+    stream->events = events;
+  }
   int status = process_spawn(proc, has_input, true, true);
   if (status) {
     loop_poll_events(&main_loop, 0);
@@ -871,9 +909,9 @@ static int do_os_system(char **argv, const char *input, size_t len, char **outpu
     wstream_init(&proc->in, 0);
   }
   rstream_init(&proc->out, 0);
-  rstream_start(&proc->out, data_cb, &buf);
+  rstream_start(&proc->out, data_cb, data);
   rstream_init(&proc->err, 0);
-  rstream_start(&proc->err, data_cb, &buf);
+  rstream_start(&proc->err, data_cb, data);
 
   // write the input, if any
   if (has_input) {
@@ -899,10 +937,13 @@ static int do_os_system(char **argv, const char *input, size_t len, char **outpu
     lines_left = -1;
   }
   int exitcode = process_wait(proc, -1, NULL);
-  if (!got_int && out_data_decide_throttle(0)) {
+  const char *skipped;
+  size_t skipped_len = throttle_end(&throttle, &skipped);
+  if (!got_int && skipped_len) {
     // Last chunk of output was skipped; display it now.
-    out_data_ring(NULL, SIZE_MAX);
+    out_data_append_to_screen((char *)skipped, &skipped_len, true);
   }
+  throttle_free(&throttle);
   if (forward_output) {
     // caller should decide if wait_return is invoked
     no_wait_return++;
@@ -961,9 +1002,32 @@ static void system_data_cb(Stream *stream, RBuffer *buf, size_t count, void *dat
   dbuf->len += nread;
 }
 
-/// Tracks output received for the current executing shell command, and displays
-/// a pulsing "..." when output should be skipped. Tracking depends on the
-/// synchronous/blocking nature of ":!".
+/// Queues the output for os_system_stream(), to be passed to the callback
+/// outside of the libuv callbacks.
+static void stream_data_cb(Stream *stream, RBuffer *buf, size_t count, void *data, bool eof)
+{
+  OutputStream *ostream = data;
+
+  size_t nread = buf->size;
+  if (nread) {
+    char *chunk = xmalloc(nread);
+    rbuffer_read(buf, chunk, nread);
+    multiqueue_put(ostream->events, stream_data_event, 3, ostream, chunk,
+                   (void *)(uintptr_t)nread);
+  }
+}
+
+static void stream_data_event(void **argv)
+{
+  OutputStream *stream = argv[0];
+  char *chunk = argv[1];
+  stream->cb(chunk, (uintptr_t)argv[2], stream->data);
+  xfree(chunk);
+}
+
+/// Displays a pulsing "..." while the output of ":!" is skipped by the
+/// throttle of do_os_system(). Throttling depends on the synchronous/blocking
+/// nature of ":!".
 ///
 /// Purpose:
 ///   1. CTRL-C is more responsive. #1234 #5396
@@ -975,107 +1039,22 @@ static void system_data_cb(Stream *stream, RBuffer *buf, size_t count, void *dat
 ///      terminal and raises SIGINT out-of-band.
 ///   2. :! in terminal-Vim uses a tty (Nvim uses pipes), so commands
 ///      (e.g. `git grep`) may page themselves.
-///
-/// @param size Length of data, used with internal state to decide whether
-///             output should be skipped. size=0 resets the internal state and
-///             returns the previous decision.
-///
-/// @returns true if output should be skipped and pulse was displayed.
-///          Returns the previous decision if size=0.
-static bool out_data_decide_throttle(size_t size)
+static void out_data_pulse(Throttle *throttle, size_t pulse)
 {
-  static uint64_t started     = 0;  // Start time of the current throttle.
-  static size_t received    = 0;  // Bytes observed since last throttle.
-  static size_t visit       = 0;  // "Pulse" count of the current throttle.
   static char pulse_msg[] = { ' ', ' ', ' ', '\0' };
 
-  if (!size) {
-    bool previous_decision = (visit > 0);
-    started = received = visit = 0;
-    return previous_decision;
-  }
-
-  received += size;
-  if (received < OUT_DATA_THRESHOLD
-      // Display at least the first chunk of output even if it is big.
-      || (!started && received < size + 1000)) {
-    return false;
-  } else if (!visit) {
-    started = os_hrtime();
-  } else {
-    uint64_t since = os_hrtime() - started;
-    if (since < (visit * 0.1L * NS_1_SECOND)) {
-      return true;
-    }
-    if (since > (3 * NS_1_SECOND)) {
-      received = visit = 0;
-      return false;
-    }
-  }
-
-  visit++;
   // Pulse "..." at the bottom of the screen.
-  size_t tick = visit % 4;
+  size_t tick = pulse % 4;
   pulse_msg[0] = (tick > 0) ? '.' : ' ';
   pulse_msg[1] = (tick > 1) ? '.' : ' ';
   pulse_msg[2] = (tick > 2) ? '.' : ' ';
-  if (visit == 1) {
+  if (pulse == 1) {
     msg_puts("...\n");
   }
   msg_putchar('\r');  // put cursor at start of line
   msg_puts(pulse_msg);
   msg_putchar('\r');
   ui_flush();
-  return true;
-}
-
-/// Saves output in a quasi-ringbuffer. Used to ensure the last ~page of
-/// output for a shell-command is always displayed.
-///
-/// Init mode: Resets the internal state.
-///   output = NULL
-///   size   = 0
-/// Print mode: Displays the current saved data.
-///   output = NULL
-///   size   = SIZE_MAX
-///
-/// @param  output  Data to save, or NULL to invoke a special mode.
-/// @param  size    Length of `output`.
-static void out_data_ring(char *output, size_t size)
-{
-#define MAX_CHUNK_SIZE (OUT_DATA_THRESHOLD / 2)
-  static char last_skipped[MAX_CHUNK_SIZE];  // Saved output.
-  static size_t last_skipped_len = 0;
-
-  assert(output != NULL || (size == 0 || size == SIZE_MAX));
-
-  if (output == NULL && size == 0) {          // Init mode
-    last_skipped_len = 0;
-    return;
-  }
-
-  if (output == NULL && size == SIZE_MAX) {   // Print mode
-    out_data_append_to_screen(last_skipped, &last_skipped_len, true);
-    return;
-  }
-
-  // This is basically a ring-buffer...
-  if (size >= MAX_CHUNK_SIZE) {               // Save mode
-    size_t start = size - MAX_CHUNK_SIZE;
-    memcpy(last_skipped, output + start, MAX_CHUNK_SIZE);
-    last_skipped_len = MAX_CHUNK_SIZE;
-  } else if (size > 0) {
-    // Length of the old data that can be kept.
-    size_t keep_len   = MIN(last_skipped_len, MAX_CHUNK_SIZE - size);
-    size_t keep_start = last_skipped_len - keep_len;
-    // Shift the kept part of the old data to the start.
-    if (keep_start) {
-      memmove(last_skipped, last_skipped + keep_start, keep_len);
-    }
-    // Copy the entire new data to the remaining space.
-    memcpy(last_skipped + keep_len, output, size);
-    last_skipped_len = keep_len + size;
-  }
 }
 
 /// Continue to append data to last screen line.
@@ -1119,11 +1098,9 @@ static void out_data_cb(Stream *stream, RBuffer *buf, size_t count, void *data,
   size_t cnt;
   char *ptr = rbuffer_read_ptr(buf, &cnt);
 
-  if (ptr != NULL && cnt > 0
-      && out_data_decide_throttle(cnt)) {  // Skip output above a threshold.
-    // Save the skipped output. If it is the final chunk, we display it later.
-    out_data_ring(ptr, cnt);
-  } else if (ptr != NULL) {
+  // Skip output above a threshold. The throttle saves the skipped output; if
+  // it is the final chunk, we display it later.
+  if (ptr != NULL && !throttle_skip(data, ptr, cnt)) {
     out_data_append_to_screen(ptr, &cnt, eof);
   }
 
@@ -16,6 +16,9 @@ typedef enum {
   kShellOptHideMess = 64,  ///< previously a global variable from os_unix.c
 } ShellOpts;
 
+/// Callback of os_system_stream(), with the next chunk of output.
+typedef void (*shell_output_cb)(const char *output, size_t len, void *data);
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "os/shell.h.generated.h"
 #endif
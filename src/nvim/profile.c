@@ -2,12 +2,15 @@
 // it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <assert.h>
+#include <inttypes.h>
 #include <math.h>
+#include <stdarg.h>
 #include <stdio.h>
 
 #include "nvim/assert.h"
 #include "nvim/func_attr.h"
-#include "nvim/globals.h"  // for the global `time_fd` (startuptime)
+#include "nvim/globals.h"  // for the globals `time_fd` and `trace_fd`
+#include "nvim/os/os.h"
 #include "nvim/os/os_defs.h"
 #include "nvim/os/time.h"
 #include "nvim/profile.h"
@@ -289,3 +292,96 @@ void time_msg(const char *mesg, const proftime_T *start)
   g_prev_time = now;
   fprintf(time_fd, ": %s\n", mesg);
 }
+
+/// Number of spans begun since `:trace start` and not ended yet.
+static int trace_depth = 0;
+static int64_t trace_pid;
+
+/// Starts writing trace events to a file, in the Chrome trace event format
+/// (for chrome://tracing or https://ui.perfetto.dev).
+///
+/// @return false if the file could not be opened.
+bool trace_start(const char *fname)
+{
+  trace_stop();
+  FILE *fd = os_fopen(fname, "w");
+  if (fd == NULL) {
+    return false;
+  }
+  trace_fd = fd;
+  trace_depth = 0;
+  trace_pid = os_get_pid();
+  fprintf(trace_fd, "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%" PRId64
+          ",\"tid\":1,\"args\":{\"name\":\"nvim\"}}", trace_pid);
+  return true;
+}
+
+/// Ends the open spans and closes the trace file.
+void trace_stop(void)
+{
+  if (trace_fd == NULL) {
+    return;
+  }
+  while (trace_depth > 0) {
+    trace_end();
+  }
+  fputs("\n]\n", trace_fd);
+  fclose(trace_fd);
+  trace_fd = NULL;
+}
+
+/// Begins a span, use TRACE_BEGIN() instead.
+///
+/// @param cat  Category of the span, like "autocmd".
+/// @param fmt  Name of the span.
+void trace_begin(const char *cat, const char *fmt, ...)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PRINTF(2, 3)
+{
+  char name[256];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(name, sizeof(name), fmt, ap);
+  va_end(ap);
+
+  trace_depth++;
+  trace_event('B');
+  fputs(",\"cat\":", trace_fd);
+  trace_string(cat);
+  fputs(",\"name\":", trace_fd);
+  trace_string(name);
+  fputc('}', trace_fd);
+}
+
+/// Ends the last span, use TRACE_END() instead.
+void trace_end(void)
+{
+  if (trace_depth == 0) {
+    return;  // Begun before `:trace start`.
+  }
+  trace_depth--;
+  trace_event('E');
+  fputc('}', trace_fd);
+}
+
+static void trace_event(char ph)
+{
+  uint64_t now = os_hrtime();
+  fprintf(trace_fd, ",\n{\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03" PRIu64
+          ",\"pid\":%" PRId64 ",\"tid\":1", ph, now / 1000, now % 1000, trace_pid);
+}
+
+static void trace_string(const char *s)
+{
+  fputc('"', trace_fd);
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') {
+      fputc('\\', trace_fd);
+      fputc(*s, trace_fd);
+    } else if ((uint8_t)(*s) < 0x20) {
+      fprintf(trace_fd, "\\u%04x", (uint8_t)(*s));
+    } else {
+      fputc(*s, trace_fd);
+    }
+  }
+  fputc('"', trace_fd);
+}
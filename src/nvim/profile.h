@@ -10,6 +10,16 @@ typedef uint64_t proftime_T;
   if (time_fd != NULL) time_msg(s, NULL); \
 } while (0)
 
+/// Begins a span of the trace started with `:trace start`, see trace_begin().
+/// Each TRACE_BEGIN() must be followed by a TRACE_END().
+#define TRACE_BEGIN(...) do { \
+  if (trace_fd != NULL) trace_begin(__VA_ARGS__); \
+} while (0)
+
+#define TRACE_END() do { \
+  if (trace_fd != NULL) trace_end(); \
+} while (0)
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "profile.h.generated.h"
 #endif
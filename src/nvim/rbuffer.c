@@ -2,6 +2,7 @@
 // it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -21,10 +22,11 @@ RBuffer *rbuffer_new(size_t capacity)
     capacity = 0x10000;
   }
 
-  RBuffer *rv = xcalloc(1, sizeof(RBuffer) + capacity);
+  RBuffer *rv = xcalloc(1, sizeof(RBuffer));
   rv->full_cb = rv->nonfull_cb = NULL;
   rv->data = NULL;
   rv->size = 0;
+  rv->start_ptr = xcalloc(1, capacity);
   rv->write_ptr = rv->read_ptr = rv->start_ptr;
   rv->end_ptr = rv->start_ptr + capacity;
   rv->temp = NULL;
@@ -34,6 +36,7 @@ RBuffer *rbuffer_new(size_t capacity)
 void rbuffer_free(RBuffer *buf)
 {
   xfree(buf->temp);
+  xfree(buf->start_ptr);
   xfree(buf);
 }
 
@@ -91,6 +94,54 @@ void rbuffer_reset(RBuffer *buf) FUNC_ATTR_NONNULL_ALL
   }
 }
 
+/// Changes the capacity of an RBuffer, which must be at least its size. The
+/// data is moved to the beginning of new memory, so pointers into the buffer
+/// become invalid. Does not invoke the callbacks.
+void rbuffer_resize(RBuffer *buf, size_t capacity) FUNC_ATTR_NONNULL_ALL
+{
+  assert(capacity && capacity >= buf->size);
+  char *data = xmalloc(capacity);
+  size_t rcnt;
+  char *rptr = rbuffer_read_ptr(buf, &rcnt);
+  memcpy(data, rptr, rcnt);
+  memcpy(data + rcnt, buf->start_ptr, buf->size - rcnt);
+  xfree(buf->start_ptr);
+  XFREE_CLEAR(buf->temp);
+  buf->start_ptr = buf->read_ptr = data;
+  buf->end_ptr = data + capacity;
+  buf->write_ptr = buf->size == capacity ? data : data + buf->size;
+}
+
+/// Takes the memory holding the first `count` bytes of an RBuffer, instead of
+/// copying them out. The data must start at the beginning of the memory (see
+/// rbuffer_reset()). The RBuffer continues with new memory of the same
+/// capacity, where the rest of the data is copied.
+///
+/// @return The memory, `rbuffer_capacity()` bytes that the caller must free
+///         with xfree(). NULL if the data does not start at the beginning.
+char *rbuffer_take(RBuffer *buf, size_t count)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT
+{
+  assert(count && count <= buf->size);
+  if (buf->read_ptr != buf->start_ptr) {
+    return NULL;
+  }
+
+  size_t capacity = rbuffer_capacity(buf);
+  bool was_full = buf->size == capacity;
+  char *rv = buf->start_ptr;
+  buf->size -= count;
+  buf->start_ptr = buf->read_ptr = xmalloc(capacity);
+  // The data does not wrap: it starts at the beginning.
+  memcpy(buf->start_ptr, rv + count, buf->size);
+  buf->write_ptr = buf->start_ptr + buf->size;
+  buf->end_ptr = buf->start_ptr + capacity;
+  if (buf->nonfull_cb && was_full) {
+    buf->nonfull_cb(buf, buf->data);
+  }
+  return rv;
+}
+
 /// Adjust `rbuffer` write pointer to reflect produced data. This is called
 /// automatically by `rbuffer_write`, but when using `rbuffer_write_ptr`
 /// directly, this needs to called after the data was copied to the internal
@@ -8,7 +8,8 @@
 // - The event loop writes data to a RBuffer, advancing the write pointer
 // - The main loop reads data, advancing the read pointer
 // - If the buffer becomes full(size == capacity) the rstream is temporarily
-//   stopped(automatic backpressure handling)
+//   stopped(automatic backpressure handling), or the buffer grows when the
+//   data arrives fast(see rstream_adapt())
 //
 // Reference: http://en.wikipedia.org/wiki/Circular_buffer
 #ifndef NVIM_RBUFFER_H
@@ -80,8 +81,7 @@ struct rbuffer {
   size_t size;
   // helper memory used to by rbuffer_reset if required
   char *temp;
-  char *end_ptr, *read_ptr, *write_ptr;
-  char start_ptr[];
+  char *start_ptr, *end_ptr, *read_ptr, *write_ptr;
 };
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
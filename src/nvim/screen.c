@@ -106,6 +106,7 @@
 #include "nvim/path.h"
 #include "nvim/plines.h"
 #include "nvim/popupmnu.h"
+#include "nvim/profile.h"
 #include "nvim/quickfix.h"
 #include "nvim/regexp.h"
 #include "nvim/screen.h"
@@ -375,6 +376,7 @@ int update_screen(int type)
     return FAIL;
   }
   updating_screen = 1;
+  TRACE_BEGIN("redraw", "update_screen");
 
   display_tick++;           // let syntax code know we're in a next round of
                             // display updating
@@ -673,6 +675,7 @@ int update_screen(int type)
 
   // either cmdline is cleared, not drawn or mode is last drawn
   cmdline_was_last_drawn = false;
+  TRACE_END();
   return OK;
 }
 
@@ -817,6 +820,7 @@ static void win_update(win_T *wp, Providers *providers)
     return;
   }
 
+  TRACE_BEGIN("redraw", "win_update %d", wp->handle);
   init_search_hl(wp);
 
   /* Force redraw when width of 'number' or 'relativenumber' column
@@ -1792,6 +1796,7 @@ static void win_update(win_T *wp, Providers *providers)
   if (!got_int) {
     got_int = save_got_int;
   }
+  TRACE_END();
 }  // NOLINT(readability/fn_size)
 
 /// Returns width of the signcolumn that should be used for the whole window
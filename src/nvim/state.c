@@ -9,12 +9,14 @@
 #include "nvim/eval.h"
 #include "nvim/ex_docmd.h"
 #include "nvim/getchar.h"
+#include "nvim/keymap.h"
 #include "nvim/lib/kvec.h"
 #include "nvim/log.h"
 #include "nvim/main.h"
 #include "nvim/option.h"
 #include "nvim/option_defs.h"
 #include "nvim/os/input.h"
+#include "nvim/profile.h"
 #include "nvim/state.h"
 #include "nvim/ui.h"
 #include "nvim/vim.h"
@@ -76,7 +78,9 @@ getkey:
     log_key(DEBUG_LOG_LEVEL, key);
 #endif
 
+    TRACE_BEGIN("loop", "%s", key == K_EVENT ? "K_EVENT" : (char *)get_special_key_name(key, 0));
     int execute_result = s->execute(s, key);
+    TRACE_END();
     if (!execute_result) {
       break;
     } else if (execute_result == -1) {
@@ -92,10 +96,7 @@ getkey:
 void state_handle_k_event(void)
 {
   while (true) {
-    Event event = multiqueue_get(main_loop.events);
-    if (event.handler) {
-      event.handler(event.argv);
-    }
+    multiqueue_process_next(main_loop.events);
 
     if (multiqueue_empty(main_loop.events)) {
       // don't breakcheck before return, caller should return to main-loop
@@ -53,9 +53,11 @@
 #include "nvim/ex_cmds.h"
 #include "nvim/ex_docmd.h"
 #include "nvim/fileio.h"
+#include "nvim/garray.h"
 #include "nvim/getchar.h"
 #include "nvim/highlight.h"
 #include "nvim/keymap.h"
+#include "nvim/lib/kvec.h"
 #include "nvim/log.h"
 #include "nvim/macros.h"
 #include "nvim/main.h"
@@ -68,6 +70,7 @@
 #include "nvim/move.h"
 #include "nvim/option.h"
 #include "nvim/os/input.h"
+#include "nvim/os/time.h"
 #include "nvim/screen.h"
 #include "nvim/state.h"
 #include "nvim/syntax.h"
@@ -91,12 +94,22 @@ typedef struct terminal_state {
 // Delay for refreshing the terminal buffer after receiving updates from
 // libvterm. Improves performance when receiving large bursts of data.
 #define REFRESH_DELAY 10
+// A terminal that received more than REFRESH_FLOOD_BYTES since its last
+// refresh, or that is not shown in the current tabpage, is refreshed at most
+// every REFRESH_DELAY_SLOW milliseconds. Updates in between are merged.
+#define REFRESH_FLOOD_BYTES (64 * 1024)
+#define REFRESH_DELAY_SLOW 100
 
 static TimeWatcher refresh_timer;
 static bool refresh_pending = false;
 
+// Scrollback rows older than the SB_HOT_ROWS most recent ones are packed, see
+// sb_pack(). They are unpacked again when they are drawn or popped.
+#define SB_HOT_ROWS 1000
+
 typedef struct {
   size_t cols;
+  size_t packed;  // size of the packed row in bytes, 0 if `cells` is used
   VTermScreenCell cells[];
 } ScrollbackLine;
 
@@ -109,9 +122,15 @@ struct terminal {
   //  - receive data from libvterm as a result of key presses.
   char textbuf[0x1fff];
 
-  ScrollbackLine **sb_buffer;       // Scrollback buffer storage for libvterm
+  // Scrollback buffer storage for libvterm, a ring of sb_size rows of which
+  // sb_current are used. Use sb_row() to access it.
+  ScrollbackLine **sb_buffer;
   size_t sb_current;                // number of rows pushed to sb_buffer
   size_t sb_size;                   // sb_buffer size
+  size_t sb_head;                   // sb_buffer index of the newest row
+  // Most recently unpacked scrollback row and the packed row it came from.
+  ScrollbackLine *sb_unpacked;
+  const ScrollbackLine *sb_unpacked_src;
   // "virtual index" that points to the first sb_buffer row that we need to
   // push to the terminal buffer when refreshing the scrollback. When negative,
   // it actually points to entries that are no longer in sb_buffer (because the
@@ -131,6 +150,8 @@ struct terminal {
   // some vterm properties
   bool forward_mouse;
   int invalid_start, invalid_end;   // invalid rows in libvterm screen
+  size_t refresh_bytes;             // bytes received since the last refresh
+  uint64_t last_refresh;            // time of the last refresh (ms)
   struct {
     int row, col;
     bool visible;
@@ -236,6 +257,7 @@ Terminal *terminal_open(buf_T *buf, TerminalOptions opts)
   // Configure the scrollback buffer.
   rv->sb_size = (size_t)buf->b_p_scbk;
   rv->sb_buffer = xmalloc(sizeof(ScrollbackLine *) * rv->sb_size);
+  rv->sb_head = 0;
 
   // Configure the color palette. Try to get the color from:
   //
@@ -588,9 +610,10 @@ void terminal_destroy(Terminal *term)
       pmap_del(ptr_t)(&invalidated_terminals, term);
     }
     for (size_t i = 0; i < term->sb_current; i++) {
-      xfree(term->sb_buffer[i]);
+      xfree(*sb_row(term, i));
     }
     xfree(term->sb_buffer);
+    xfree(term->sb_unpacked);
     vterm_free(term->vt);
     xfree(term);
   }
@@ -699,7 +722,11 @@ void terminal_receive(Terminal *term, char *data, size_t len)
   }
 
   vterm_input_write(term->vt, data, len);
-  vterm_screen_flush_damage(term->vts);
+  g_stats.term_bytes += (int64_t)len;
+  term->refresh_bytes += len;
+  // Damage is flushed by refresh_terminal(), so that libvterm merges it
+  // across reads.
+  invalidate_terminal(term, -1, -1);
 }
 
 static int get_rgb(VTermState *state, VTermColor color)
@@ -792,12 +819,14 @@ bool terminal_running(const Terminal *term)
 
 static int term_damage(VTermRect rect, void *data)
 {
+  g_stats.term_damage++;
   invalidate_terminal(data, rect.start_row, rect.end_row);
   return 1;
 }
 
 static int term_moverect(VTermRect dest, VTermRect src, void *data)
 {
+  g_stats.term_damage++;
   invalidate_terminal(data, MIN(dest.start_row, src.start_row),
                       MAX(dest.end_row, src.end_row));
   return 1;
@@ -876,29 +905,25 @@ static int term_sb_push(int cols, const VTermScreenCell *cells, void *data)
   size_t c = (size_t)cols;
   ScrollbackLine *sbrow = NULL;
   if (term->sb_current == term->sb_size) {
-    if (term->sb_buffer[term->sb_current - 1]->cols == c) {
+    ScrollbackLine *oldest = *sb_row(term, term->sb_current - 1);
+    if (!oldest->packed && oldest->cols == c) {
       // Recycle old row if it's the right size
-      sbrow = term->sb_buffer[term->sb_current - 1];
+      sbrow = oldest;
     } else {
-      xfree(term->sb_buffer[term->sb_current - 1]);
+      sb_free(term, oldest);
     }
-
-    // Make room at the start by shifting to the right.
-    memmove(term->sb_buffer + 1, term->sb_buffer,
-            sizeof(term->sb_buffer[0]) * (term->sb_current - 1));
-  } else if (term->sb_current > 0) {
-    // Make room at the start by shifting to the right.
-    memmove(term->sb_buffer + 1, term->sb_buffer,
-            sizeof(term->sb_buffer[0]) * term->sb_current);
   }
 
   if (!sbrow) {
     sbrow = xmalloc(sizeof(ScrollbackLine) + c * sizeof(sbrow->cells[0]));
     sbrow->cols = c;
+    sbrow->packed = 0;
   }
 
-  // New row is added at the start of the storage buffer.
-  term->sb_buffer[0] = sbrow;
+  // New row is added at the start of the ring, taking the place of the oldest
+  // row if it is full.
+  term->sb_head = (term->sb_head + term->sb_size - 1) % term->sb_size;
+  term->sb_buffer[term->sb_head] = sbrow;
   if (term->sb_current < term->sb_size) {
     term->sb_current++;
   }
@@ -908,6 +933,15 @@ static int term_sb_push(int cols, const VTermScreenCell *cells, void *data)
   }
 
   memcpy(sbrow->cells, cells, sizeof(cells[0]) * c);
+
+  // The row that just left the hot window is packed.
+  if (term->sb_current > SB_HOT_ROWS) {
+    ScrollbackLine **cold = sb_row(term, SB_HOT_ROWS);
+    if (!(*cold)->packed) {
+      *cold = sb_pack(*cold);
+    }
+  }
+
   pmap_put(ptr_t)(&invalidated_terminals, term, NULL);
 
   return 1;
@@ -930,25 +964,25 @@ static int term_sb_pop(int cols, VTermScreenCell *cells, void *data)
     term->sb_pending--;
   }
 
-  ScrollbackLine *sbrow = term->sb_buffer[0];
+  ScrollbackLine *sbrow = *sb_row(term, 0);
+  const ScrollbackLine *src = sb_cells(term, 0);
   term->sb_current--;
-  // Forget the "popped" row by shifting the rest onto it.
-  memmove(term->sb_buffer, term->sb_buffer + 1,
-          sizeof(term->sb_buffer[0]) * (term->sb_current));
+  // Forget the "popped" row.
+  term->sb_head = (term->sb_head + 1) % term->sb_size;
 
   size_t cols_to_copy = (size_t)cols;
-  if (cols_to_copy > sbrow->cols) {
-    cols_to_copy = sbrow->cols;
+  if (cols_to_copy > src->cols) {
+    cols_to_copy = src->cols;
   }
 
   // copy to vterm state
-  memcpy(cells, sbrow->cells, sizeof(cells[0]) * cols_to_copy);
+  memcpy(cells, src->cells, sizeof(cells[0]) * cols_to_copy);
   for (size_t col = cols_to_copy; col < (size_t)cols; col++) {
     cells[col].chars[0] = 0;
     cells[col].width = 1;
   }
 
-  xfree(sbrow);
+  sb_free(term, sbrow);
   pmap_put(ptr_t)(&invalidated_terminals, term, NULL);
 
   return 1;
@@ -1334,7 +1368,7 @@ static void fetch_row(Terminal *term, int row, int end_col)
 static bool fetch_cell(Terminal *term, int row, int col, VTermScreenCell *cell)
 {
   if (row < 0) {
-    ScrollbackLine *sbrow = term->sb_buffer[-row - 1];
+    const ScrollbackLine *sbrow = sb_cells(term, (size_t)(-row - 1));
     if ((size_t)col < sbrow->cols) {
       *cell = sbrow->cells[col];
     } else {
@@ -1378,6 +1412,10 @@ static void refresh_terminal(Terminal *term)
     }
     return;
   }
+  vterm_screen_flush_damage(term->vts);
+  g_stats.term_refreshes++;
+  term->refresh_bytes = 0;
+  term->last_refresh = os_hrtime() / 1000000;
   long ml_before = buf->b_ml.ml_line_count;
 
   // refresh_ functions assume the terminal buffer is current
@@ -1391,22 +1429,53 @@ static void refresh_terminal(Terminal *term)
   long ml_added = buf->b_ml.ml_line_count - ml_before;
   adjust_topline(term, buf, ml_added);
 }
-// Calls refresh_terminal() on all invalidated_terminals.
+/// Checks if an invalidated terminal should be refreshed now, or if it gets
+/// so much output or is hidden so that the refresh should wait some more.
+static bool refresh_due(Terminal *term, uint64_t now)
+{
+  if (now - term->last_refresh >= REFRESH_DELAY_SLOW
+      || term->closed || term->pending_resize) {
+    return true;
+  }
+  if (term->refresh_bytes > REFRESH_FLOOD_BYTES) {
+    return false;
+  }
+  FOR_ALL_WINDOWS_IN_TAB(wp, curtab) {
+    if (wp->w_buffer && wp->w_buffer->terminal == term) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Calls refresh_terminal() on all invalidated_terminals that are due.
 static void refresh_timer_cb(TimeWatcher *watcher, void *data)
 {
-  refresh_pending = false;
   if (exiting) {  // Cannot redraw (requires event loop) during teardown/exit.
+    refresh_pending = false;
     return;
   }
+  uint64_t now = os_hrtime() / 1000000;
+  kvec_t(Terminal *) postponed = KV_INITIAL_VALUE;
   Terminal *term;
   void *stub; (void)(stub);
   // don't process autocommands while updating terminal buffers
   block_autocmds();
   map_foreach(&invalidated_terminals, term, stub, {
-    refresh_terminal(term);
+    if (refresh_due(term, now)) {
+      refresh_terminal(term);
+    } else {
+      kv_push(postponed, term);
+    }
   });
   pmap_clear(ptr_t)(&invalidated_terminals);
   unblock_autocmds();
+
+  refresh_pending = false;
+  for (size_t i = 0; i < kv_size(postponed); i++) {
+    invalidate_terminal(kv_A(postponed, i), -1, -1);
+  }
+  kv_destroy(postponed);
 }
 
 static void refresh_size(Terminal *term, buf_T *buf)
@@ -1435,26 +1504,182 @@ static void on_scrollback_option_changed(Terminal *term, buf_T *buf)
     abort();
   }
 
+  if (scbk == term->sb_size) {
+    return;
+  }
+
   // Delete lines exceeding the new 'scrollback' limit.
   if (scbk < term->sb_current) {
     size_t diff = term->sb_current - scbk;
     for (size_t i = 0; i < diff; i++) {
       ml_delete(1, false);
+      // The oldest row, at the top of the buffer.
+      sb_free(term, *sb_row(term, term->sb_current - 1));
       term->sb_current--;
-      xfree(term->sb_buffer[term->sb_current]);
     }
     deleted_lines(1, (long)diff);
   }
 
-  // Resize the scrollback storage.
-  size_t sb_region = sizeof(ScrollbackLine *) * scbk;
-  if (scbk != term->sb_size) {
-    term->sb_buffer = xrealloc(term->sb_buffer, sb_region);
+  // Resize the scrollback storage, moving the newest row to the start.
+  ScrollbackLine **sb_buffer = xmalloc(sizeof(ScrollbackLine *) * scbk);
+  for (size_t i = 0; i < term->sb_current; i++) {
+    sb_buffer[i] = *sb_row(term, i);
   }
-
+  xfree(term->sb_buffer);
+  term->sb_buffer = sb_buffer;
+  term->sb_head = 0;
   term->sb_size = scbk;
 }
 
+/// Gets the scrollback row `i`, 0 being the most recently pushed one.
+static inline ScrollbackLine **sb_row(Terminal *term, size_t i)
+{
+  assert(i < term->sb_current);
+  return &term->sb_buffer[(term->sb_head + i) % term->sb_size];
+}
+
+/// Gets the cells of scrollback row `i`, unpacking it if needed. The result is
+/// valid until the next call.
+static const ScrollbackLine *sb_cells(Terminal *term, size_t i)
+{
+  const ScrollbackLine *sbrow = *sb_row(term, i);
+  if (!sbrow->packed) {
+    return sbrow;
+  }
+  if (term->sb_unpacked_src != sbrow) {
+    term->sb_unpacked = xrealloc(term->sb_unpacked,
+                                 sizeof(ScrollbackLine)
+                                 + sbrow->cols * sizeof(sbrow->cells[0]));
+    term->sb_unpacked->cols = sbrow->cols;
+    term->sb_unpacked->packed = 0;
+    sb_unpack(sbrow, term->sb_unpacked->cells);
+    term->sb_unpacked_src = sbrow;
+  }
+  return term->sb_unpacked;
+}
+
+static void sb_free(Terminal *term, ScrollbackLine *sbrow)
+{
+  if (term->sb_unpacked_src == sbrow) {
+    term->sb_unpacked_src = NULL;
+  }
+  xfree(sbrow);
+}
+
+static void sb_put_varint(garray_T *ga, uint32_t n)
+{
+  while (n >= 0x80) {
+    ga_append(ga, (char)(n | 0x80));
+    n >>= 7;
+  }
+  ga_append(ga, (char)n);
+}
+
+static uint32_t sb_get_varint(const uint8_t **pp)
+{
+  uint32_t n = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t b = *(*pp)++;
+    n |= (uint32_t)(b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      return n;
+    }
+  }
+}
+
+static bool sb_same_pen(const VTermScreenCell *a, const VTermScreenCell *b)
+{
+  return !memcmp(&a->attrs, &b->attrs, sizeof(a->attrs))
+         && !memcmp(&a->fg, &b->fg, sizeof(a->fg))
+         && !memcmp(&a->bg, &b->bg, sizeof(a->bg));
+}
+
+/// Packs a scrollback row, freeing `sbrow`.
+///
+/// The cells are stored as runs of cells with the same attributes and colors:
+/// the length of the run and the pen, followed by the cells. A plain ASCII
+/// cell takes a single byte, other cells are stored as a byte with 0x80 set,
+/// the width in bits 3-6 and the number of chars in bits 0-2, followed by the
+/// chars. Lengths and chars are varints. A typical row shrinks from
+/// sizeof(VTermScreenCell) to about one byte per cell.
+static ScrollbackLine *sb_pack(ScrollbackLine *sbrow)
+{
+  garray_T ga;
+  ga_init(&ga, 1, (int)sbrow->cols + 64);
+  size_t col = 0;
+  while (col < sbrow->cols) {
+    const VTermScreenCell *pen = &sbrow->cells[col];
+    size_t end = col + 1;
+    while (end < sbrow->cols && sb_same_pen(pen, &sbrow->cells[end])) {
+      end++;
+    }
+    sb_put_varint(&ga, (uint32_t)(end - col));
+    ga_concat_len(&ga, (const char *)&pen->attrs, sizeof(pen->attrs));
+    ga_concat_len(&ga, (const char *)&pen->fg, sizeof(pen->fg));
+    ga_concat_len(&ga, (const char *)&pen->bg, sizeof(pen->bg));
+    for (; col < end; col++) {
+      const VTermScreenCell *cell = &sbrow->cells[col];
+      int nchars = 0;
+      while (nchars < VTERM_MAX_CHARS_PER_CELL && cell->chars[nchars]) {
+        nchars++;
+      }
+      if (nchars == 1 && cell->width == 1 && cell->chars[0] < 0x80) {
+        ga_append(&ga, (char)cell->chars[0]);
+        continue;
+      }
+      assert(cell->width >= 0 && cell->width < 16);
+      ga_append(&ga, (char)(0x80 | (cell->width << 3) | nchars));
+      for (int i = 0; i < nchars; i++) {
+        sb_put_varint(&ga, cell->chars[i]);
+      }
+    }
+  }
+
+  size_t packed = (size_t)ga.ga_len;
+  ScrollbackLine *rv = xmalloc(sizeof(ScrollbackLine) + MAX(packed, 1));
+  rv->cols = sbrow->cols;
+  rv->packed = MAX(packed, 1);
+  if (packed) {
+    memcpy(rv->cells, ga.ga_data, packed);
+  }
+  ga_clear(&ga);
+  xfree(sbrow);
+  return rv;
+}
+
+/// Unpacks a row packed by sb_pack() into `cells`, which has room for
+/// `sbrow->cols` cells.
+static void sb_unpack(const ScrollbackLine *sbrow, VTermScreenCell *cells)
+{
+  const uint8_t *p = (const uint8_t *)sbrow->cells;
+  size_t col = 0;
+  while (col < sbrow->cols) {
+    size_t count = sb_get_varint(&p);
+    VTermScreenCell pen;
+    memset(&pen, 0, sizeof(pen));
+    memcpy(&pen.attrs, p, sizeof(pen.attrs));
+    p += sizeof(pen.attrs);
+    memcpy(&pen.fg, p, sizeof(pen.fg));
+    p += sizeof(pen.fg);
+    memcpy(&pen.bg, p, sizeof(pen.bg));
+    p += sizeof(pen.bg);
+    for (size_t i = 0; i < count; i++, col++) {
+      VTermScreenCell *cell = &cells[col];
+      *cell = pen;
+      uint8_t b = *p++;
+      if (b < 0x80) {
+        cell->chars[0] = b;
+        cell->width = 1;
+        continue;
+      }
+      cell->width = (char)((b >> 3) & 0xf);
+      for (int k = 0; k < (b & 7); k++) {
+        cell->chars[k] = sb_get_varint(&p);
+      }
+    }
+  }
+}
+
 // Refresh the scrollback of an invalidated terminal.
 static void refresh_scrollback(Terminal *term, buf_T *buf)
 {
@@ -1472,21 +1697,28 @@ static void refresh_scrollback(Terminal *term, buf_T *buf)
   }
 
   row_offset -= term->sb_pending;
-  while (term->sb_pending > 0) {
+  if (term->sb_pending > 0) {
     // This means that either the window height has decreased or the screen
-    // became full and libvterm had to push all rows up. Convert the first
-    // pending scrollback row into a string and append it just above the visible
-    // section of the buffer
-    if (((int)buf->b_ml.ml_line_count - height) >= (int)term->sb_size) {
-      // scrollback full, delete lines at the top
-      ml_delete(1, false);
-      deleted_lines(1, 1);
+    // became full and libvterm had to push all rows up. If the scrollback is
+    // full, first delete the lines at the top that the pending rows push out.
+    int overflow = (int)buf->b_ml.ml_line_count - height + term->sb_pending
+                   - (int)term->sb_size;
+    if (overflow > 0) {
+      for (int i = 0; i < overflow; i++) {
+        ml_delete(1, false);
+      }
+      deleted_lines(1, overflow);
     }
-    fetch_row(term, -term->sb_pending - row_offset, width);
+    // Convert the pending scrollback rows into strings and append them just
+    // above the visible section of the buffer.
     int buf_index = (int)buf->b_ml.ml_line_count - height;
-    ml_append(buf_index, (uint8_t *)term->textbuf, 0, false);
-    appended_lines(buf_index, 1);
-    term->sb_pending--;
+    int count = term->sb_pending;
+    while (term->sb_pending > 0) {
+      fetch_row(term, -term->sb_pending - row_offset, width);
+      ml_append(buf_index + count - term->sb_pending, (uint8_t *)term->textbuf, 0, false);
+      term->sb_pending--;
+    }
+    appended_lines(buf_index, count);
   }
 
   // Remove extra lines at the bottom
@@ -8,6 +8,7 @@
 #include "nvim/aucmd.h"
 #include "nvim/charset.h"
 #include "nvim/ex_docmd.h"
+#include "nvim/garray.h"
 #include "nvim/macros.h"
 #include "nvim/main.h"
 #include "nvim/option.h"
@@ -21,6 +22,14 @@
 #include "nvim/event/rstream.h"
 
 #define KEY_BUFFER_SIZE 0xfff
+#define READ_BUFFER_SIZE 0xffff
+
+/// Pasted text waiting for nvim_paste(), see tinput_paste_piece_event().
+typedef struct {
+  garray_T data;
+  bool first;  ///< Starts a paste.
+  bool last;  ///< Ends a paste.
+} PasteChunk;
 
 #ifndef UNIT_TESTING
 typedef enum {
@@ -80,7 +89,7 @@ void tinput_init(TermInput *input, Loop *loop)
   termkey_set_canonflags(input->tk, curflags | TERMKEY_CANON_DELBS);
 
   // setup input handle
-  rstream_init_fd(loop, &input->read_stream, input->in_fd, 0xfff);
+  rstream_init_fd(loop, &input->read_stream, input->in_fd, READ_BUFFER_SIZE);
   // initialize a timer handle for handling ESC with libtermkey
   time_watcher_init(loop, &input->timer_handle, input);
 }
@@ -114,33 +123,15 @@ static void tinput_done_event(void **argv)
 static void tinput_wait_enqueue(void **argv)
 {
   TermInput *input = argv[0];
-  if (rbuffer_size(input->key_buffer) == 0 && input->paste == 3) {
-    const String keys = { .data = "", .size = 0 };
-    String copy = copy_string(keys);
-    multiqueue_put(main_loop.events, tinput_paste_event, 3,
-                   copy.data, copy.size, (intptr_t)input->paste);
-  }
   RBUFFER_UNTIL_EMPTY(input->key_buffer, buf, len) {
     const String keys = { .data = buf, .size = len };
-    if (input->paste) {
-      String copy = copy_string(keys);
-      multiqueue_put(main_loop.events, tinput_paste_event, 3,
-                     copy.data, copy.size, (intptr_t)input->paste);
-      if (input->paste == 1) {
-        // Paste phase: "continue"
-        input->paste = 2;
-      }
-      rbuffer_consumed(input->key_buffer, len);
-      rbuffer_reset(input->key_buffer);
-    } else {
-      const size_t consumed = input_enqueue(keys);
-      if (consumed) {
-        rbuffer_consumed(input->key_buffer, consumed);
-      }
-      rbuffer_reset(input->key_buffer);
-      if (consumed < len) {
-        break;
-      }
+    const size_t consumed = input_enqueue(keys);
+    if (consumed) {
+      rbuffer_consumed(input->key_buffer, consumed);
+    }
+    rbuffer_reset(input->key_buffer);
+    if (consumed < len) {
+      break;
     }
   }
   uv_mutex_lock(&input->key_buffer_mutex);
@@ -149,10 +140,48 @@ static void tinput_wait_enqueue(void **argv)
   uv_mutex_unlock(&input->key_buffer_mutex);
 }
 
+/// Chunk that is queued for tinput_paste_event() and still accepts text.
+/// Only used on the main thread.
+static PasteChunk *open_chunk = NULL;
+
+/// Receives a piece of pasted text from the TUI thread (fast event).
+///
+/// Pieces that arrive while the previous one is still queued are appended to
+/// it, so that nvim_paste() is called with chunks as large as the main thread
+/// falls behind, and the screen is only redrawn once the queue is empty.
+static void tinput_paste_piece_event(void **argv)
+{
+  char *data = argv[0];
+  size_t size = (size_t)argv[1];
+  bool first = (bool)argv[2];
+  bool last = (bool)argv[3];
+
+  PasteChunk *chunk = open_chunk;
+  if (!chunk || first) {
+    chunk = xmalloc(sizeof(PasteChunk));
+    ga_init(&chunk->data, 1, 0x10000);
+    // Take over the piece, it often is the only one.
+    chunk->data.ga_data = data;
+    chunk->data.ga_len = chunk->data.ga_maxlen = (int)size;
+    chunk->first = first;
+    multiqueue_put(main_loop.events, tinput_paste_event, 1, chunk);
+  } else {
+    ga_concat_len(&chunk->data, data, size);
+    xfree(data);
+  }
+  chunk->last = last;
+  open_chunk = last ? NULL : chunk;
+}
+
 static void tinput_paste_event(void **argv)
 {
-  String keys = { .data = argv[0], .size = (size_t)argv[1] };
-  intptr_t phase = (intptr_t)argv[2];
+  PasteChunk *chunk = argv[0];
+  if (chunk == open_chunk) {
+    open_chunk = NULL;
+  }
+  String keys = { .data = chunk->data.ga_data, .size = (size_t)chunk->data.ga_len };
+  // Paste phases: -1=all 1=first-chunk 2=continue 3=last-chunk
+  intptr_t phase = chunk->first ? (chunk->last ? -1 : 1) : (chunk->last ? 3 : 2);
 
   Error err = ERROR_INIT;
   nvim_paste(keys, true, phase, &err);
@@ -161,7 +190,22 @@ static void tinput_paste_event(void **argv)
     api_clear_error(&err);
   }
 
-  api_free_string(keys);
+  ga_clear(&chunk->data);
+  xfree(chunk);
+}
+
+/// Hands pasted text to the main thread.
+static void tinput_paste_push(TermInput *input, const char *buf, size_t size, bool last)
+{
+  bool first = input->paste == 1;
+  if (!size && first && last) {
+    return;  // Empty paste.
+  }
+  loop_schedule_fast(&main_loop,
+                     event_create(tinput_paste_piece_event, 4, xmemdup(buf, size),
+                                  (void *)size, (void *)(intptr_t)first,
+                                  (void *)(intptr_t)last));
+  input->paste = 2;
 }
 
 static void tinput_flush(TermInput *input, bool wait_until_empty)
@@ -409,8 +453,7 @@ static HandleState handle_bracketed_paste(TermInput *input)
       input->paste = 1;
     } else if (input->paste) {
       // Paste phase: "last-chunk".
-      input->paste = input->paste == 2 ? 3 : -1;
-      tinput_flush(input, true);
+      tinput_paste_push(input, "", 0, true);
       // Paste phase: "disabled".
       input->paste = 0;
     }
@@ -579,6 +622,18 @@ static void handle_raw_buffer(TermInput *input, bool force)
       continue;
     }
 
+    // Push pasted bytes directly, in bulk up to the next ESC (which may start
+    // the "stop paste" code).
+    if (input->paste) {
+      size_t len;
+      char *ptr = rbuffer_read_ptr(input->read_stream.buffer, &len);
+      char *esc = len > 1 ? memchr(ptr + 1, '\x1b', len - 1) : NULL;
+      size_t count = esc ? (size_t)(esc - ptr) : len;
+      tinput_paste_push(input, ptr, count, false);
+      rbuffer_consumed(input->read_stream.buffer, count);
+      continue;
+    }
+
     //
     // Find the next ESC and push everything up to it (excluding), so it will
     // be the first thing encountered on the next iteration. The `handle_*`
@@ -592,19 +647,6 @@ static void handle_raw_buffer(TermInput *input, bool force)
         break;
       }
     }
-    // Push bytes directly (paste).
-    if (input->paste) {
-      RBUFFER_UNTIL_EMPTY(input->read_stream.buffer, ptr, len) {
-        size_t consumed = MIN(count, len);
-        assert(consumed <= input->read_stream.buffer->size);
-        tinput_enqueue(input, ptr, consumed);
-        rbuffer_consumed(input->read_stream.buffer, consumed);
-        if (!(count -= consumed)) {
-          break;
-        }
-      }
-      continue;
-    }
     // Push through libtermkey (translates to "<keycode>" strings, etc.).
     RBUFFER_UNTIL_EMPTY(input->read_stream.buffer, ptr, len) {
       size_t consumed = termkey_push_bytes(input->tk, ptr, MIN(count, len));
@@ -9,7 +9,7 @@
 
 typedef struct term_input {
   int in_fd;
-  // Phases: -1=all 0=disabled 1=first-chunk 2=continue 3=last-chunk
+  // 0=disabled 1=first-chunk 2=continue
   int8_t paste;
   bool waiting;
   bool ttimeout;
@@ -47,7 +47,12 @@
 // Space reserved in two output buffers to make the cursor normal or invisible
 // when flushing. No existing terminal will require 32 bytes to do that.
 #define CNORM_COMMAND_MAX_SIZE 32
+// Normal size of the output buffer. It grows so that a whole frame (all
+// output between two flushes) is written at once, and shrinks back after.
 #define OUTBUF_SIZE 0xffff
+// Beyond this size the output buffer is flushed before the frame ends, to
+// bound memory if the main thread never sends "flush".
+#define OUTBUF_MAX_SIZE (16 * 1024 * 1024)
 
 #define TOO_MANY_EVENTS 1000000
 #define STARTS_WITH(str, prefix) \
@@ -71,15 +76,33 @@ typedef struct {
   int top, bot, left, right;
 } Rect;
 
+// Cost of an unavailable capability; small enough that sums don't overflow.
+#define COST_INF (INT_MAX / 4)
+
+/// Byte costs of cursor motions, measured from terminfo in terminfo_start().
+/// Parametrized capabilities are measured with one-digit arguments and
+/// adjusted for the actual number of digits, see param_cost().
+typedef struct {
+  int home, cr, cup;
+  int cub1, cuf1, cuu1, cud1;
+  int cub, cuf, cuu, cud;
+  int rep, ech;
+} TermCosts;
+
 typedef struct {
   UIBridgeData *bridge;
   Loop *loop;
   unibi_var_t params[9];
-  char buf[OUTBUF_SIZE];
+  char *buf;
+  size_t bufsize;
   size_t bufpos;
   char norm[CNORM_COMMAND_MAX_SIZE];
   char invis[CNORM_COMMAND_MAX_SIZE];
   size_t normlen, invislen;
+  // Begin/end synchronized update (DEC mode 2026), empty if unsupported.
+  char sync_begin[CNORM_COMMAND_MAX_SIZE];
+  char sync_end[CNORM_COMMAND_MAX_SIZE];
+  size_t sync_beginlen, sync_endlen;
   TermInput input;
   uv_loop_t write_loop;
   unibi_term *ut;
@@ -92,6 +115,7 @@ typedef struct {
   bool cont_received;
   UGrid grid;
   kvec_t(Rect) invalid_regions;
+  TermCosts costs;
   int row, col;
   int out_fd;
   bool scroll_region_is_full_screen;
@@ -104,7 +128,7 @@ typedef struct {
   bool bce;
   bool mouse_enabled;
   bool busy, is_invisible, want_invisible;
-  bool cork, overflow;
+  bool cork;
   bool cursor_color_changed;
   bool is_starting;
   FILE *screenshot;
@@ -131,6 +155,7 @@ typedef struct {
     int get_bg;
     int set_underline_style;
     int set_underline_color;
+    int sync;
   } unibi_ext;
   char *space_buf;
 } TUIData;
@@ -187,6 +212,70 @@ static size_t unibi_pre_fmt_str(TUIData *data, unsigned int unibi_index, char *b
   return unibi_run(str, data->params, buf, len);
 }
 
+static size_t unibi_pre_fmt_ext_str(TUIData *data, int unibi_index, char *buf, size_t len)
+{
+  if (unibi_index < 0) {
+    return 0U;
+  }
+  const char *str = unibi_get_ext_str(data->ut, (unsigned)unibi_index);
+  if (!str) {
+    return 0U;
+  }
+  return unibi_run(str, data->params, buf, len);
+}
+
+/// Number of bytes `unibi_index` expands to with the given parameters, or
+/// COST_INF if the terminal lacks the capability.
+static int unibi_cost(TUIData *data, enum unibi_string unibi_index, int p1, int p2)
+{
+  const char *str = unibi_get_str(data->ut, unibi_index);
+  if (!str) {
+    return COST_INF;
+  }
+  char buf[64];
+  UNIBI_SET_NUM_VAR(data->params[0], p1);
+  UNIBI_SET_NUM_VAR(data->params[1], p2);
+  return (int)unibi_run(str, data->params, buf, sizeof buf);
+}
+
+static void measure_costs(TUIData *data)
+{
+  TermCosts *c = &data->costs;
+  c->home = unibi_cost(data, unibi_cursor_home, 0, 0);
+  c->cr = unibi_cost(data, unibi_carriage_return, 0, 0);
+  c->cup = unibi_cost(data, unibi_cursor_address, 0, 0);
+  c->cub1 = unibi_cost(data, unibi_cursor_left, 0, 0);
+  c->cuf1 = unibi_cost(data, unibi_cursor_right, 0, 0);
+  c->cuu1 = unibi_cost(data, unibi_cursor_up, 0, 0);
+  c->cud1 = unibi_cost(data, unibi_cursor_down, 0, 0);
+  c->cub = unibi_cost(data, unibi_parm_left_cursor, 1, 0);
+  c->cuf = unibi_cost(data, unibi_parm_right_cursor, 1, 0);
+  c->cuu = unibi_cost(data, unibi_parm_up_cursor, 1, 0);
+  c->cud = unibi_cost(data, unibi_parm_down_cursor, 1, 0);
+  c->rep = unibi_cost(data, unibi_repeat_char, 'x', 2);
+  c->ech = unibi_cost(data, unibi_erase_chars, 1, 0);
+}
+
+/// Cost of a capability measured with a one-digit argument, used with `n`.
+static int param_cost(int cost, int n)
+{
+  if (cost >= COST_INF) {
+    return COST_INF;
+  }
+  while (n >= 10) {
+    cost++;
+    n /= 10;
+  }
+  return cost;
+}
+
+/// Cheapest way to move `n` steps using either the single-step or the
+/// parametrized capability.
+static int step_cost(int single, int parm, int n)
+{
+  return MIN(single >= COST_INF ? COST_INF : single * n, param_cost(parm, n));
+}
+
 static void termname_set_event(void **argv)
 {
   char *termname = argv[0];
@@ -205,7 +294,6 @@ static void terminfo_start(UI *ui)
   data->want_invisible = false;
   data->busy = false;
   data->cork = false;
-  data->overflow = false;
   data->cursor_color_changed = false;
   data->showing_mode = SHAPE_IDX_N;
   data->unibi_ext.enable_mouse = -1;
@@ -225,6 +313,7 @@ static void terminfo_start(UI *ui)
   data->unibi_ext.reset_cursor_style = -1;
   data->unibi_ext.get_bg = -1;
   data->unibi_ext.set_underline_color = -1;
+  data->unibi_ext.sync = -1;
   data->out_fd = STDOUT_FILENO;
   data->out_isatty = os_isatty(data->out_fd);
 
@@ -293,6 +382,17 @@ static void terminfo_start(UI *ui)
                                     data->norm, sizeof data->norm);
   data->invislen = unibi_pre_fmt_str(data, unibi_cursor_invisible,
                                      data->invis, sizeof data->invis);
+  // "Sync" takes 1 to begin and 2 to end a synchronized update.
+  UNIBI_SET_NUM_VAR(data->params[0], 1);
+  data->sync_beginlen = unibi_pre_fmt_ext_str(data, data->unibi_ext.sync,
+                                              data->sync_begin, sizeof data->sync_begin);
+  UNIBI_SET_NUM_VAR(data->params[0], 2);
+  data->sync_endlen = unibi_pre_fmt_ext_str(data, data->unibi_ext.sync,
+                                            data->sync_end, sizeof data->sync_end);
+  if (!data->sync_beginlen || !data->sync_endlen) {
+    data->sync_beginlen = data->sync_endlen = 0;
+  }
+  measure_costs(data);
   // Set 't_Co' from the result of unibilium & fix_terminfo.
   t_colors = unibi_get_num(data->ut, unibi_max_colors);
   // Enter alternate screen, save title, and clear.
@@ -435,6 +535,8 @@ static void tui_main(UIBridgeData *bridge, UI *ui)
   data->loop = &tui_loop;
   data->is_starting = true;
   data->screenshot = NULL;
+  data->bufsize = OUTBUF_SIZE;
+  data->buf = xmalloc(data->bufsize);
   kv_init(data->invalid_regions);
   signal_watcher_init(data->loop, &data->winch_handle, ui);
   signal_watcher_init(data->loop, &data->cont_handle, data);
@@ -478,6 +580,7 @@ static void tui_main(UIBridgeData *bridge, UI *ui)
   kv_destroy(data->invalid_regions);
   kv_destroy(data->attrs);
   xfree(data->space_buf);
+  xfree(data->buf);
   xfree(data);
 }
 
@@ -533,6 +636,63 @@ static bool attrs_differ(UI *ui, int id1, int id2, bool rgb)
   }
 }
 
+/// Gets the foreground or background color `attrs` is printed with, -1 for
+/// the terminal default. Sets `rgb` if it is a RGB color.
+static int attrs_color(UI *ui, HlAttrs attrs, bool fg, bool *rgb)
+{
+  TUIData *data = ui->data;
+  int attr = ui->rgb ? attrs.rgb_ae_attr : attrs.cterm_ae_attr;
+  *rgb = ui->rgb && !(attr & (fg ? HL_FG_INDEXED : HL_BG_INDEXED));
+  if (*rgb) {
+    int color = fg ? attrs.rgb_fg_color : attrs.rgb_bg_color;
+    return color != -1 ? color : (fg ? data->clear_attrs.rgb_fg_color
+                                     : data->clear_attrs.rgb_bg_color);
+  }
+  int color = fg ? attrs.cterm_fg_color : attrs.cterm_bg_color;
+  return color ? color - 1 : (fg ? data->clear_attrs.cterm_fg_color
+                                 : data->clear_attrs.cterm_bg_color) - 1;
+}
+
+static void set_color(UI *ui, bool fg, int color, bool rgb)
+{
+  TUIData *data = ui->data;
+  if (color == -1) {
+    return;
+  }
+  if (rgb) {
+    UNIBI_SET_NUM_VAR(data->params[0], (color >> 16) & 0xff);  // red
+    UNIBI_SET_NUM_VAR(data->params[1], (color >> 8) & 0xff);   // green
+    UNIBI_SET_NUM_VAR(data->params[2], color & 0xff);          // blue
+    unibi_out_ext(ui, fg ? data->unibi_ext.set_rgb_foreground
+                         : data->unibi_ext.set_rgb_background);
+  } else {
+    UNIBI_SET_NUM_VAR(data->params[0], color);
+    unibi_out(ui, fg ? unibi_set_a_foreground : unibi_set_a_background);
+  }
+}
+
+/// Returns true if switching from `prev_id` to `attrs` only needs new colors:
+/// the attributes are the same and no color goes back to the default (which
+/// needs a reset).
+static bool attrs_color_only(UI *ui, int prev_id, HlAttrs attrs, int fg, int bg)
+{
+  TUIData *data = ui->data;
+  if (prev_id < 0) {
+    return false;
+  }
+  HlAttrs prev = kv_A(data->attrs, (size_t)prev_id);
+  int attr = ui->rgb ? attrs.rgb_ae_attr : attrs.cterm_ae_attr;
+  int prev_attr = ui->rgb ? prev.rgb_ae_attr : prev.cterm_ae_attr;
+  if (attr != prev_attr
+      || ((attr & (HL_UNDERLINE|HL_UNDERCURL)) && attrs.rgb_sp_color != prev.rgb_sp_color)) {
+    return false;
+  }
+  bool prev_fg_rgb, prev_bg_rgb;
+  int prev_fg = attrs_color(ui, prev, true, &prev_fg_rgb);
+  int prev_bg = attrs_color(ui, prev, false, &prev_bg_rgb);
+  return (fg != -1 || prev_fg == -1) && (bg != -1 || prev_bg == -1);
+}
+
 static void update_attrs(UI *ui, int attr_id)
 {
   TUIData *data = ui->data;
@@ -541,6 +701,7 @@ static void update_attrs(UI *ui, int attr_id)
     data->print_attr_id = attr_id;
     return;
   }
+  int prev_id = data->print_attr_id;
   data->print_attr_id = attr_id;
   HlAttrs attrs = kv_A(data->attrs, (size_t)attr_id);
   int attr = ui->rgb ? attrs.rgb_ae_attr : attrs.cterm_ae_attr;
@@ -561,6 +722,25 @@ static void update_attrs(UI *ui, int attr_id)
     undercurl = false;
   }
 
+  bool fg_rgb, bg_rgb;
+  int fg = attrs_color(ui, attrs, true, &fg_rgb);
+  int bg = attrs_color(ui, attrs, false, &bg_rgb);
+
+  if (attrs_color_only(ui, prev_id, attrs, fg, bg)) {
+    // Minimal SGR delta: only send the colors that changed.
+    bool prev_fg_rgb, prev_bg_rgb;
+    HlAttrs prev = kv_A(data->attrs, (size_t)prev_id);
+    int prev_fg = attrs_color(ui, prev, true, &prev_fg_rgb);
+    int prev_bg = attrs_color(ui, prev, false, &prev_bg_rgb);
+    if (fg != prev_fg || fg_rgb != prev_fg_rgb) {
+      set_color(ui, true, fg, fg_rgb);
+    }
+    if (bg != prev_bg || bg_rgb != prev_bg_rgb) {
+      set_color(ui, false, bg, bg_rgb);
+    }
+    goto end;
+  }
+
   if (unibi_get_str(data->ut, unibi_set_attributes)) {
     if (bold || reverse || underline || standout) {
       UNIBI_SET_NUM_VAR(data->params[0], standout);
@@ -613,44 +793,10 @@ static void update_attrs(UI *ui, int attr_id)
     }
   }
 
-  int fg, bg;
-  if (ui->rgb && !(attr & HL_FG_INDEXED)) {
-    fg = ((attrs.rgb_fg_color != -1)
-          ? attrs.rgb_fg_color : data->clear_attrs.rgb_fg_color);
-    if (fg != -1) {
-      UNIBI_SET_NUM_VAR(data->params[0], (fg >> 16) & 0xff);  // red
-      UNIBI_SET_NUM_VAR(data->params[1], (fg >> 8) & 0xff);   // green
-      UNIBI_SET_NUM_VAR(data->params[2], fg & 0xff);          // blue
-      unibi_out_ext(ui, data->unibi_ext.set_rgb_foreground);
-    }
-  } else {
-    fg = (attrs.cterm_fg_color
-          ? attrs.cterm_fg_color - 1 : (data->clear_attrs.cterm_fg_color - 1));
-    if (fg != -1) {
-      UNIBI_SET_NUM_VAR(data->params[0], fg);
-      unibi_out(ui, unibi_set_a_foreground);
-    }
-  }
-
-  if (ui->rgb && !(attr & HL_BG_INDEXED)) {
-    bg = ((attrs.rgb_bg_color != -1)
-          ? attrs.rgb_bg_color : data->clear_attrs.rgb_bg_color);
-    if (bg != -1) {
-      UNIBI_SET_NUM_VAR(data->params[0], (bg >> 16) & 0xff);  // red
-      UNIBI_SET_NUM_VAR(data->params[1], (bg >> 8) & 0xff);   // green
-      UNIBI_SET_NUM_VAR(data->params[2], bg & 0xff);          // blue
-      unibi_out_ext(ui, data->unibi_ext.set_rgb_background);
-    }
-  } else {
-    bg = (attrs.cterm_bg_color
-          ? attrs.cterm_bg_color - 1 : (data->clear_attrs.cterm_bg_color - 1));
-    if (bg != -1) {
-      UNIBI_SET_NUM_VAR(data->params[0], bg);
-      unibi_out(ui, unibi_set_a_background);
-    }
-  }
-
+  set_color(ui, true, fg, fg_rgb);
+  set_color(ui, false, bg, bg_rgb);
 
+end:
   data->default_attr = fg == -1 && bg == -1
                        && !bold && !italic && !underline && !undercurl && !reverse && !standout
                        && !strikethrough;
@@ -694,30 +840,143 @@ static void print_cell(UI *ui, UCell *ptr)
   }
 }
 
-static bool cheap_to_print(UI *ui, int row, int col, int next)
+/// Prints the cells from `startcol` to `endcol` of `row`. A run of the same
+/// ASCII character is sent with REP (repeat_char) when that is shorter.
+static void print_cells(UI *ui, int row, int startcol, int endcol)
 {
   TUIData *data = ui->data;
   UGrid *grid = &data->grid;
-  UCell *cell = grid->cells[row] + col;
-  while (next) {
-    next--;
-    if (attrs_differ(ui, cell->attr,
-                     data->print_attr_id, ui->rgb)) {
-      if (data->default_attr) {
-        return false;
+  UCell *cells = grid->cells[row];
+  for (int col = startcol; col < endcol; col++) {
+    cursor_goto(ui, row, col);
+    UCell *cell = &cells[col];
+    int n = 1;
+    if (data->costs.rep < COST_INF && is_ascii_cell(cell)) {
+      while (col + n < endcol && cells[col + n].attr == cell->attr
+             && !strcmp(cells[col + n].data, cell->data)) {
+        n++;
       }
     }
-    if (strlen(cell->data) > 1) {
-      return false;
+    // Stay away from the right margin, where wrapping behavior differs.
+    if (n > 1 && col + n < ui->width && param_cost(data->costs.rep, n - 1) < n) {
+      if (!data->immediate_wrap_after_last_column) {
+        final_column_wrap(ui);
+      }
+      update_attrs(ui, cell->attr);
+      UNIBI_SET_NUM_VAR(data->params[0], (uint8_t)cell->data[0]);
+      UNIBI_SET_NUM_VAR(data->params[1], n);
+      unibi_out(ui, unibi_repeat_char);
+      grid->col += n;
+      col += n - 1;
+    } else {
+      print_cell(ui, cell);
     }
-    cell++;
   }
-  return true;
 }
 
-/// This optimizes several cases where it is cheaper to do something other
-/// than send a full cursor positioning control sequence.  However, there are
-/// some further optimizations that may seem obvious but that will not work.
+/// Returns true if `cell` is a single printable ASCII character.
+static bool is_ascii_cell(const UCell *cell)
+{
+  return (uint8_t)cell->data[0] >= 0x20 && (uint8_t)cell->data[0] < 0x7f
+         && cell->data[1] == NUL;
+}
+
+/// Cost of moving right by `n` columns on `row` by printing the cells that are
+/// already there, or COST_INF if that would change the attributes.
+static int reprint_cost(UI *ui, int row, int col, int n)
+{
+  TUIData *data = ui->data;
+  UCell *cell = data->grid.cells[row] + col;
+  for (int i = 0; i < n; i++, cell++) {
+    if (!is_ascii_cell(cell)
+        || attrs_differ(ui, cell->attr, data->print_attr_id, ui->rgb)) {
+      return COST_INF;
+    }
+  }
+  return n;
+}
+
+/// Cost of a horizontal motion from `from` to `to` on `row`.
+static int horizontal_cost(UI *ui, int row, int from, int to)
+{
+  TermCosts *c = &((TUIData *)ui->data)->costs;
+  if (to < from) {
+    return step_cost(c->cub1, c->cub, from - to);
+  } else if (to > from) {
+    return MIN(step_cost(c->cuf1, c->cuf, to - from),
+               reprint_cost(ui, row, from, to - from));
+  }
+  return 0;
+}
+
+/// Cost of a vertical motion from `from` to `to`.
+static int vertical_cost(TermCosts *c, int from, int to)
+{
+  if (to > from) {
+    return step_cost(c->cud1, c->cud, to - from);
+  } else if (to < from) {
+    return step_cost(c->cuu1, c->cuu, from - to);
+  }
+  return 0;
+}
+
+/// Moves the cursor `n` steps, using whichever of `single` or `parm` is
+/// cheaper.
+static void cursor_step(UI *ui, int single, int single_cost, int parm, int parm_cost_1, int n)
+{
+  TUIData *data = ui->data;
+  if (step_cost(single_cost, COST_INF, n) <= param_cost(parm_cost_1, n)) {
+    while (n--) {
+      unibi_out(ui, single);
+    }
+  } else {
+    UNIBI_SET_NUM_VAR(data->params[0], n);
+    unibi_out(ui, parm);
+  }
+}
+
+/// Moves the cursor to `col` on the current row, see horizontal_cost().
+static void cursor_horizontal(UI *ui, int col)
+{
+  TUIData *data = ui->data;
+  UGrid *grid = &data->grid;
+  TermCosts *c = &data->costs;
+  int n = col - grid->col;
+  if (n < 0) {
+    cursor_step(ui, unibi_cursor_left, c->cub1, unibi_parm_left_cursor, c->cub, -n);
+  } else if (n > 0) {
+    if (reprint_cost(ui, grid->row, grid->col, n) < step_cost(c->cuf1, c->cuf, n)) {
+      UCell *cells = grid->cells[grid->row];
+      while (grid->col < col) {
+        print_cell(ui, &cells[grid->col]);
+      }
+      return;
+    }
+    cursor_step(ui, unibi_cursor_right, c->cuf1, unibi_parm_right_cursor, c->cuf, n);
+  }
+  ugrid_goto(grid, grid->row, col);
+}
+
+/// Moves the cursor to `row` on the current column, see vertical_cost().
+static void cursor_vertical(UI *ui, int row)
+{
+  TUIData *data = ui->data;
+  UGrid *grid = &data->grid;
+  TermCosts *c = &data->costs;
+  int n = row - grid->row;
+  if (n > 0) {
+    cursor_step(ui, unibi_cursor_down, c->cud1, unibi_parm_down_cursor, c->cud, n);
+  } else if (n < 0) {
+    cursor_step(ui, unibi_cursor_up, c->cuu1, unibi_parm_up_cursor, c->cuu, -n);
+  }
+  ugrid_goto(grid, row, grid->col);
+}
+
+/// Moves the cursor with the fewest bytes, comparing the costs (measured from
+/// terminfo) of absolute positioning, relative motion, CR followed by
+/// relative motion, and printing over cells that are already correct.
+/// However, there are some further optimizations that may seem obvious but
+/// that will not work.
 ///
 /// We cannot use VT (ASCII 0/11) for moving the cursor up, because VT means
 /// move the cursor down on a DEC terminal.  Similarly, on a DEC terminal FF
@@ -728,10 +987,12 @@ static void cursor_goto(UI *ui, int row, int col)
 {
   TUIData *data = ui->data;
   UGrid *grid = &data->grid;
+  TermCosts *c = &data->costs;
   if (row == grid->row && col == grid->col) {
     return;
   }
-  if (0 == row && 0 == col) {
+  int abs_cost = param_cost(param_cost(c->cup, row + 1), col + 1);
+  if (0 == row && 0 == col && c->home <= abs_cost) {
     unibi_out(ui, unibi_cursor_home);
     ugrid_goto(grid, row, col);
     return;
@@ -739,76 +1000,26 @@ static void cursor_goto(UI *ui, int row, int col)
   if (grid->row == -1) {
     goto safe_move;
   }
-  if (0 == col ? col != grid->col :
-      row != grid->row ? false :
-      1 == col ? 2 < grid->col && cheap_to_print(ui, grid->row, 0, col) :
-      2 == col ? 5 < grid->col && cheap_to_print(ui, grid->row, 0, col) :
-      false) {
-    // Motion to left margin from anywhere else, or CR + printing chars is
-    // even less expensive than using BSes or CUB.
+
+  int vcost = vertical_cost(c, grid->row, row);
+  // Deferred right margin wrap terminals have inconsistent ideas about where
+  // the cursor actually is during a deferred wrap.  Relative motion
+  // calculations have OBOEs that cannot be compensated for, because two
+  // terminals that claim to be the same will implement different cursor
+  // positioning rules.  CR is fine, it always goes to the left margin.
+  int rel_cost = (data->immediate_wrap_after_last_column || grid->col < ui->width)
+                 ? vcost + horizontal_cost(ui, row, grid->col, col) : COST_INF;
+  int cr_cost = c->cr + vcost + horizontal_cost(ui, row, 0, col);
+
+  if (cr_cost < rel_cost && cr_cost < abs_cost) {
     unibi_out(ui, unibi_carriage_return);
     ugrid_goto(grid, grid->row, 0);
+  } else if (rel_cost >= abs_cost) {
+    goto safe_move;
   }
-  if (row == grid->row) {
-    if (col < grid->col
-        // Deferred right margin wrap terminals have inconsistent ideas about
-        // where the cursor actually is during a deferred wrap.  Relative
-        // motion calculations have OBOEs that cannot be compensated for,
-        // because two terminals that claim to be the same will implement
-        // different cursor positioning rules.
-        && (data->immediate_wrap_after_last_column || grid->col < ui->width)) {
-      int n = grid->col - col;
-      if (n <= 4) {  // This might be just BS, so it is considered really cheap.
-        while (n--) {
-          unibi_out(ui, unibi_cursor_left);
-        }
-      } else {
-        UNIBI_SET_NUM_VAR(data->params[0], n);
-        unibi_out(ui, unibi_parm_left_cursor);
-      }
-      ugrid_goto(grid, row, col);
-      return;
-    } else if (col > grid->col) {
-      int n = col - grid->col;
-      if (n <= 2) {
-        while (n--) {
-          unibi_out(ui, unibi_cursor_right);
-        }
-      } else {
-        UNIBI_SET_NUM_VAR(data->params[0], n);
-        unibi_out(ui, unibi_parm_right_cursor);
-      }
-      ugrid_goto(grid, row, col);
-      return;
-    }
-  }
-  if (col == grid->col) {
-    if (row > grid->row) {
-      int n = row - grid->row;
-      if (n <= 4) {  // This might be just LF, so it is considered really cheap.
-        while (n--) {
-          unibi_out(ui, unibi_cursor_down);
-        }
-      } else {
-        UNIBI_SET_NUM_VAR(data->params[0], n);
-        unibi_out(ui, unibi_parm_down_cursor);
-      }
-      ugrid_goto(grid, row, col);
-      return;
-    } else if (row < grid->row) {
-      int n = grid->row - row;
-      if (n <= 2) {
-        while (n--) {
-          unibi_out(ui, unibi_cursor_up);
-        }
-      } else {
-        UNIBI_SET_NUM_VAR(data->params[0], n);
-        unibi_out(ui, unibi_parm_up_cursor);
-      }
-      ugrid_goto(grid, row, col);
-      return;
-    }
-  }
+  cursor_vertical(ui, row);
+  cursor_horizontal(ui, col);
+  return;
 
 safe_move:
   unibi_goto(ui, row, col);
@@ -841,7 +1052,8 @@ static void clear_region(UI *ui, int top, int bot, int left, int right, int attr
       cursor_goto(ui, row, left);
       if (data->can_clear_attr && right == ui->width) {
         unibi_out(ui, unibi_clr_eol);
-      } else if (data->can_erase_chars && data->can_clear_attr && width >= 5) {
+      } else if (data->can_erase_chars && data->can_clear_attr
+                 && param_cost(data->costs.ech, width) < width) {
         UNIBI_SET_NUM_VAR(data->params[0], width);
         unibi_out(ui, unibi_erase_chars);
       } else {
@@ -1241,10 +1453,7 @@ static void tui_flush(UI *ui)
         }
       }
 
-      UGRID_FOREACH_CELL(grid, row, r.left, clear_col, {
-        cursor_goto(ui, row, curcol);
-        print_cell(ui, cell);
-      });
+      print_cells(ui, row, r.left, clear_col);
       if (clear_col < r.right) {
         clear_region(ui, row, row+1, clear_col, r.right, clear_attr);
       }
@@ -1382,10 +1591,7 @@ static void tui_raw_line(UI *ui, Integer g, Integer linerow, Integer startcol, I
     assert((size_t)attrs[c-startcol] < kv_size(data->attrs));
     grid->cells[linerow][c].attr = attrs[c-startcol];
   }
-  UGRID_FOREACH_CELL(grid, (int)linerow, (int)startcol, (int)endcol, {
-    cursor_goto(ui, (int)linerow, curcol);
-    print_cell(ui, cell);
-  });
+  print_cells(ui, (int)linerow, (int)startcol, (int)endcol);
 
   if (clearcol > endcol) {
     ugrid_clear_chunk(grid, (int)linerow, (int)endcol, (int)clearcol,
@@ -1505,16 +1711,9 @@ static void unibi_goto(UI *ui, int row, int col)
     } \
     if (str) { \
       unibi_var_t vars[26 + 26]; \
-      size_t orig_pos = data->bufpos; \
       memset(&vars, 0, sizeof(vars)); \
       data->cork = true; \
-retry: \
       unibi_format(vars, vars + 26, str, data->params, out, ui, NULL, NULL); \
-      if (data->overflow) { \
-        data->bufpos = orig_pos; \
-        flush_buf(ui); \
-        goto retry; \
-      } \
       data->cork = false; \
     } \
   } while (0)
@@ -1532,19 +1731,21 @@ static void out(void *ctx, const char *str, size_t len)
 {
   UI *ui = ctx;
   TUIData *data = ui->data;
-  size_t available = sizeof(data->buf) - data->bufpos;
-
-  if (data->cork && data->overflow) {
-    return;
-  }
 
-  if (len > available) {
-    if (data->cork) {
-      data->overflow = true;
-      return;
-    } else {
+  if (len > data->bufsize - data->bufpos) {
+    // A terminal sequence is never split (cork), otherwise only flush early if
+    // the frame is unreasonably large.
+    if (!data->cork && data->bufpos + len > OUTBUF_MAX_SIZE) {
       flush_buf(ui);
     }
+    size_t bufsize = data->bufsize;
+    while (len > bufsize - data->bufpos) {
+      bufsize *= 2;
+    }
+    if (bufsize != data->bufsize) {
+      data->buf = xrealloc(data->buf, bufsize);
+      data->bufsize = bufsize;
+    }
   }
 
   memcpy(data->buf + data->bufpos, str, len);
@@ -1612,6 +1813,7 @@ static void patch_terminfo_bugs(TUIData *data, const char *term, const char *col
                || terminfo_is_term_family(term, "iTerm.app")
                || terminfo_is_term_family(term, "iTerm2.app");
   bool alacritty = terminfo_is_term_family(term, "alacritty");
+  bool foot = terminfo_is_term_family(term, "foot");
   // None of the following work over SSH; see :help TERM .
   bool iterm_pretending_xterm = xterm && iterm_env;
   bool gnome_pretending_xterm = xterm && colorterm
@@ -1756,6 +1958,13 @@ static void patch_terminfo_bugs(TUIData *data, const char *term, const char *col
     // No bugs in the vanilla terminfo for our purposes.
   }
 
+  // Terminals that pretend to be xterm inherit "rep" from its terminfo, but
+  // many don't implement REP (e.g. libvterm before 0.2, used by :terminal).
+  if (unibi_get_str(ut, unibi_repeat_char) && !true_xterm && !kitty && !foot) {
+    ILOG("Disabling rep for a terminal not known to support it.");
+    unibi_set_str(ut, unibi_repeat_char, NULL);
+  }
+
 // At this time (2017-07-12) it seems like all terminals that support 256
 // color codes can use semicolons in the terminal code and be fine.
 // However, this is not correct according to the spec. So to reward those
@@ -1919,6 +2128,9 @@ static void augment_terminfo(TUIData *data, const char *term, long vte_version,
                || terminfo_is_term_family(term, "iTerm.app")
                || terminfo_is_term_family(term, "iTerm2.app");
   bool alacritty = terminfo_is_term_family(term, "alacritty");
+  bool kitty = terminfo_is_term_family(term, "xterm-kitty");
+  bool foot = terminfo_is_term_family(term, "foot");
+  bool contour = terminfo_is_term_family(term, "contour");
   // None of the following work over SSH; see :help TERM .
   bool iterm_pretending_xterm = xterm && iterm_env;
 
@@ -2042,12 +2254,24 @@ static void augment_terminfo(TUIData *data, const char *term, long vte_version,
     data->unibi_ext.set_underline_color = (int)unibi_add_ext_str(ut, "ext.set_underline_color",
                                                                  "\x1b[58:2::%p1%d:%p2%d:%p3%dm");
   }
+
+  // Synchronized output (DEC private mode 2026). tmux and newer terminfo
+  // entries describe it as "Sync"; otherwise only enable it for terminals
+  // known to support it, others might print the sequence.
+  data->unibi_ext.sync = unibi_find_ext_str(ut, "Sync");
+  if (data->unibi_ext.sync == -1) {
+    const char *termprg = os_getenv("TERM_PROGRAM");
+    if (kitty || foot || contour || (termprg && strstr(termprg, "WezTerm"))) {
+      data->unibi_ext.sync = (int)unibi_add_ext_str(ut, "Sync",
+                                                    "\x1b[?2026%?%p1%{1}%-%tl%eh%;");
+    }
+  }
 }
 
 static void flush_buf(UI *ui)
 {
   uv_write_t req;
-  uv_buf_t bufs[3];
+  uv_buf_t bufs[5];
   uv_buf_t *bufp = &bufs[0];
   TUIData *data = ui->data;
 
@@ -2071,6 +2295,14 @@ static void flush_buf(UI *ui)
     return;
   }
 
+  // Let the terminal render the whole frame at once instead of tearing.
+  bool sync = data->bufpos > 0 && data->sync_beginlen > 0 && !data->screenshot;
+  if (sync) {
+    bufp->base = data->sync_begin;
+    bufp->len = UV_BUF_LEN(data->sync_beginlen);
+    bufp++;
+  }
+
   if (!data->is_invisible) {
     // cursor is visible. Write a "cursor invisible" command before writing the
     // buffer.
@@ -2098,20 +2330,41 @@ static void flush_buf(UI *ui)
     }
   }
 
+  if (sync) {
+    bufp->base = data->sync_end;
+    bufp->len = UV_BUF_LEN(data->sync_endlen);
+    bufp++;
+  }
+
   if (data->screenshot) {
     for (size_t i = 0; i < (size_t)(bufp - bufs); i++) {
       fwrite(bufs[i].base, bufs[i].len, 1, data->screenshot);
     }
   } else {
+    size_t nbytes = 0;
+    for (size_t i = 0; i < (size_t)(bufp - bufs); i++) {
+      nbytes += bufs[i].len;
+    }
+    // One write per frame: uv_write() issues a single writev() and only
+    // loops if the terminal accepts less than the whole frame.
     int ret = uv_write(&req, STRUCT_CAST(uv_stream_t, &data->output_handle),
                        bufs, (unsigned)(bufp - bufs), NULL);
     if (ret) {
       ELOG("uv_write failed: %s", uv_strerror(ret));
     }
     uv_run(&data->write_loop, UV_RUN_DEFAULT);
+    // Read by nvim__stats() on the main thread.
+    STATS_ADD(&g_stats.tui_writes, 1);
+    STATS_ADD(&g_stats.tui_bytes, (int64_t)nbytes);
+    STATS_STORE(&g_stats.tui_frame_bytes, (int64_t)nbytes);
   }
   data->bufpos = 0;
-  data->overflow = false;
+  if (data->bufsize > OUTBUF_SIZE) {
+    // Give back the memory of an unusually large frame.
+    xfree(data->buf);
+    data->bufsize = OUTBUF_SIZE;
+    data->buf = xmalloc(data->bufsize);
+  }
 }
 
 #if TERMKEY_VERSION_MAJOR > 0 || TERMKEY_VERSION_MINOR > 18
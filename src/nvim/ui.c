@@ -63,6 +63,10 @@ static handle_T cursor_grid_handle = DEFAULT_GRID_HANDLE;
 static bool has_mouse = false;
 static int pending_has_mouse = -1;
 
+// While set, events are only sent to this UI (and the compositor, uis[0]),
+// see ui_resync().
+static UI *ui_target = NULL;
+
 #if MIN_LOG_LEVEL > DEBUG_LOG_LEVEL
 # define UI_LOG(funname)
 #else
@@ -91,7 +95,8 @@ static char uilog_last_event[1024] = { 0 };
   } while (0)
 #endif
 
-// UI_CALL invokes a function on all registered UI instances.
+// UI_CALL invokes a function on all registered UI instances, or only on
+// `ui_target` if it is set.
 // This is called by code generated by generators/gen_api_ui_events.lua
 // C code should use ui_call_{funname} instead.
 #define UI_CALL(cond, funname, ...) \
@@ -99,7 +104,8 @@ static char uilog_last_event[1024] = { 0 };
     bool any_call = false; \
     for (size_t i = 0; i < ui_count; i++) { \
       UI *ui = uis[i]; \
-      if (ui->funname && (cond)) { \
+      if (ui->funname && (cond) \
+          && (!ui_target || ui == ui_target || i == 0)) { \
         ui->funname(__VA_ARGS__); \
         any_call = true; \
       } \
@@ -368,6 +374,22 @@ void ui_attach_impl(UI *ui, uint64_t chanid)
   }
 }
 
+/// Sends the complete state to `ui` again, as when it attached: options,
+/// highlights and a full redraw. The other UIs get none of it. Used after
+/// updates to a slow remote UI were dropped.
+void ui_resync(UI *ui)
+{
+  ui_flush();  // Pending updates are for all UIs.
+  ui_target = ui;
+  ui_refresh_options();
+  for (UIExtension i = kUIGlobalCount; (int)i < kUIExtCount; i++) {
+    ui_set_ext_option(ui, i, ui->ui_ext[i]);
+  }
+  ui_send_all_hls(ui);
+  ui_refresh();
+  ui_target = NULL;
+}
+
 void ui_detach_impl(UI *ui, uint64_t chanid)
 {
   size_t shift_index = MAX_UI_COUNT;
@@ -517,6 +539,10 @@ void ui_flush(void)
     pending_has_mouse = has_mouse;
   }
   ui_call_flush();
+  if (!input_available()) {
+    // All input so far was handled.
+    loop_stats_flush(&main_loop);
+  }
 }
 
 
@@ -24,9 +24,20 @@
 
 #define UI(b) (((UIBridgeData *)b)->ui)
 
-// Schedule a function call on the UI bridge thread.
+// Queue a function call for the UI bridge thread. It runs after the next
+// ui_bridge_wake().
 #define UI_BRIDGE_CALL(ui, name, argc, ...) \
-  ((UIBridgeData *)ui)->scheduler(event_create(ui_bridge_##name##_event, argc, __VA_ARGS__), UI(ui))
+  ui_bridge_push((UIBridgeData *)ui, event_create(ui_bridge_##name##_event, argc, __VA_ARGS__))
+
+// Positions in the rings are published with release/acquire semantics.
+#ifdef _MSC_VER
+// volatile has acquire/release semantics with /volatile:ms (x86/x64 default).
+# define RING_LOAD(p) (*(volatile size_t *)(p))
+# define RING_STORE(p, v) (*(volatile size_t *)(p) = (v))
+#else
+# define RING_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+# define RING_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
 
 #define INT2PTR(i) ((void *)(intptr_t)i)
 #define PTR2INT(p) ((Integer)(intptr_t)p)
@@ -67,6 +78,8 @@ UI *ui_bridge_attach(UI *ui, ui_main_fn ui_main, event_scheduler scheduler)
   rv->bridge.raw_line = ui_bridge_raw_line;
   rv->bridge.inspect = ui_bridge_inspect;
   rv->scheduler = scheduler;
+  rv->ring = xcalloc(UI_BRIDGE_RING_SIZE, sizeof(UIBridgeEvent));
+  rv->payload = xmalloc(UI_BRIDGE_PAYLOAD_SIZE);
 
   for (UIExtension i = 0; (int)i < kUIExtCount; i++) {
     rv->bridge.ui_ext[i] = ui->ui_ext[i];
@@ -106,6 +119,96 @@ static void ui_thread_run(void *data)
   bridge->ui_main(bridge, bridge->ui);
 }
 
+/// Schedules processing of the queued events on the UI thread.
+static void ui_bridge_wake(UIBridgeData *bridge)
+{
+  bridge->scheduler(event_create(ui_bridge_drain_event, 1, bridge), bridge->ui);
+}
+
+/// Allocates `size` bytes for the payload of the next queued event. They are
+/// valid until the event has been processed.
+static void *ui_bridge_payload_alloc(UIBridgeData *bridge, size_t size)
+{
+  assert(!bridge->pending_heap);
+  size = (size + 7) & ~(size_t)7;  // keep payloads aligned
+  size_t pos = bridge->payload_write % UI_BRIDGE_PAYLOAD_SIZE;
+  // Payloads are contiguous, skip the end of the ring if it is too short.
+  size_t skip = pos + size > UI_BRIDGE_PAYLOAD_SIZE ? UI_BRIDGE_PAYLOAD_SIZE - pos : 0;
+  if (size > UI_BRIDGE_PAYLOAD_SIZE / 2
+      || (UI_BRIDGE_PAYLOAD_SIZE - (bridge->payload_write - RING_LOAD(&bridge->payload_read))
+          < skip + size)) {
+    // Too large, or the UI thread is behind: don't wait for it.
+    bridge->pending_heap = xmalloc(size);
+    return bridge->pending_heap;
+  }
+  bridge->payload_write += skip;
+  void *rv = bridge->payload + bridge->payload_write % UI_BRIDGE_PAYLOAD_SIZE;
+  bridge->payload_write += size;
+  return rv;
+}
+
+static void ui_bridge_push(UIBridgeData *bridge, Event event)
+{
+  UIBridgeEvent ev = {
+    .event = event,
+    .payload_end = bridge->payload_write,
+    .heap = bridge->pending_heap,
+  };
+  bridge->pending_heap = NULL;
+  if (RING_LOAD(&bridge->overflowing)
+      || bridge->ring_write - RING_LOAD(&bridge->ring_read) == UI_BRIDGE_RING_SIZE) {
+    // Never wait for the UI thread here, it may be waiting for the main
+    // thread to take its input (tinput_flush()). Keep the event on the heap.
+    uv_mutex_lock(&bridge->mutex);
+    bool wake = kv_size(bridge->overflow) == 0;
+    kv_push(bridge->overflow, ev);
+    RING_STORE(&bridge->overflowing, 1);
+    uv_mutex_unlock(&bridge->mutex);
+    if (wake) {
+      ui_bridge_wake(bridge);
+    }
+    return;
+  }
+  bridge->ring[bridge->ring_write & (UI_BRIDGE_RING_SIZE - 1)] = ev;
+  RING_STORE(&bridge->ring_write, bridge->ring_write + 1);
+}
+
+/// Processes the queued events on the UI thread.
+static void ui_bridge_drain_event(void **argv)
+{
+  UIBridgeData *bridge = argv[0];
+  size_t read = bridge->ring_read;
+  for (;;) {
+    size_t write;
+    while (read != (write = RING_LOAD(&bridge->ring_write))) {
+      for (; read != write; read++) {
+        UIBridgeEvent *ev = &bridge->ring[read & (UI_BRIDGE_RING_SIZE - 1)];
+        ev->event.handler(ev->event.argv);
+        xfree(ev->heap);
+        RING_STORE(&bridge->payload_read, ev->payload_end);
+        RING_STORE(&bridge->ring_read, read + 1);
+      }
+    }
+    // The ring is empty, so the overflowed events are the oldest ones. The
+    // main thread uses the ring again once they are taken.
+    uv_mutex_lock(&bridge->mutex);
+    UIBridgeEvent *overflow = bridge->overflow.items;
+    size_t count = kv_size(bridge->overflow);
+    kv_init(bridge->overflow);
+    RING_STORE(&bridge->overflowing, 0);
+    uv_mutex_unlock(&bridge->mutex);
+    if (!count) {
+      break;
+    }
+    // Their payload is released with the next event in the ring.
+    for (size_t i = 0; i < count; i++) {
+      overflow[i].event.handler(overflow[i].event.argv);
+      xfree(overflow[i].heap);
+    }
+    xfree(overflow);
+  }
+}
+
 static void ui_bridge_stop(UI *b)
 {
   // Detach bridge first, so that "stop" is the last event the TUI loop
@@ -115,6 +218,7 @@ static void ui_bridge_stop(UI *b)
   UIBridgeData *bridge = (UIBridgeData *)b;
   bool stopped = bridge->stopped = false;
   UI_BRIDGE_CALL(b, stop, 1, b);
+  ui_bridge_wake(bridge);
   for (;;) {
     uv_mutex_lock(&bridge->mutex);
     stopped = bridge->stopped;
@@ -128,6 +232,9 @@ static void ui_bridge_stop(UI *b)
   uv_thread_join(&bridge->ui_thread);
   uv_mutex_destroy(&bridge->mutex);
   uv_cond_destroy(&bridge->cond);
+  xfree(bridge->ring);
+  xfree(bridge->payload);
+  kv_destroy(bridge->overflow);
   xfree(bridge->ui);  // Threads joined, now safe to free UI container. #7922
   xfree(b);
 }
@@ -140,7 +247,7 @@ static void ui_bridge_stop_event(void **argv)
 static void ui_bridge_hl_attr_define(UI *ui, Integer id, HlAttrs attrs, HlAttrs cterm_attrs,
                                      Array info)
 {
-  HlAttrs *a = xmalloc(sizeof(HlAttrs));
+  HlAttrs *a = ui_bridge_payload_alloc((UIBridgeData *)ui, sizeof(HlAttrs));
   *a = attrs;
   UI_BRIDGE_CALL(ui, hl_attr_define, 3, ui, INT2PTR(id), a);
 }
@@ -150,7 +257,6 @@ static void ui_bridge_hl_attr_define_event(void **argv)
   Array info = ARRAY_DICT_INIT;
   ui->hl_attr_define(ui, PTR2INT(argv[1]), *((HlAttrs *)argv[2]),
                      *((HlAttrs *)argv[2]), info);
-  xfree(argv[2]);
 }
 
 static void ui_bridge_raw_line_event(void **argv)
@@ -159,27 +265,56 @@ static void ui_bridge_raw_line_event(void **argv)
   ui->raw_line(ui, PTR2INT(argv[1]), PTR2INT(argv[2]), PTR2INT(argv[3]),
                PTR2INT(argv[4]), PTR2INT(argv[5]), PTR2INT(argv[6]),
                (LineFlags)PTR2INT(argv[7]), argv[8], argv[9]);
-  xfree(argv[8]);
-  xfree(argv[9]);
 }
 static void ui_bridge_raw_line(UI *ui, Integer grid, Integer row, Integer startcol, Integer endcol,
                                Integer clearcol, Integer clearattr, LineFlags flags,
                                const schar_T *chunk, const sattr_T *attrs)
 {
   size_t ncol = (size_t)(endcol-startcol);
-  schar_T *c = xmemdup(chunk, ncol * sizeof(schar_T));
-  sattr_T *hl = xmemdup(attrs, ncol * sizeof(sattr_T));
+  // Copy into ring-owned storage, attributes first to keep them aligned.
+  char *payload = ui_bridge_payload_alloc((UIBridgeData *)ui,
+                                          ncol * (sizeof(sattr_T) + sizeof(schar_T)));
+  sattr_T *hl = memcpy(payload, attrs, ncol * sizeof(sattr_T));
+  schar_T *c = memcpy(payload + ncol * sizeof(sattr_T), chunk, ncol * sizeof(schar_T));
   UI_BRIDGE_CALL(ui, raw_line, 10, ui, INT2PTR(grid), INT2PTR(row),
                  INT2PTR(startcol), INT2PTR(endcol), INT2PTR(clearcol),
                  INT2PTR(clearattr), INT2PTR(flags), c, hl);
 }
 
+static void ui_bridge_flush(UI *ui)
+{
+  UI_BRIDGE_CALL(ui, flush, 1, ui);
+  ui_bridge_wake((UIBridgeData *)ui);
+}
+static void ui_bridge_flush_event(void **argv)
+{
+  UI *ui = UI(argv[0]);
+  ui->flush(ui);
+}
+
+static void ui_bridge_screenshot(UI *ui, String path)
+{
+  String copy_path = copy_string(path);
+  UI_BRIDGE_CALL(ui, screenshot, 3, ui, copy_path.data, INT2PTR(copy_path.size));
+  ui_bridge_wake((UIBridgeData *)ui);
+}
+static void ui_bridge_screenshot_event(void **argv)
+{
+  UI *ui = UI(argv[0]);
+  String path = (String){ .data = argv[1], .size = (size_t)argv[2] };
+  ui->screenshot(ui, path);
+  api_free_string(path);
+}
+
 static void ui_bridge_suspend(UI *b)
 {
   UIBridgeData *data = (UIBridgeData *)b;
   uv_mutex_lock(&data->mutex);
-  UI_BRIDGE_CALL(b, suspend, 1, b);
   data->ready = false;
+  uv_mutex_unlock(&data->mutex);
+  UI_BRIDGE_CALL(b, suspend, 1, b);
+  ui_bridge_wake(data);
+  uv_mutex_lock(&data->mutex);
   // Suspend the main thread until CONTINUE is called by the UI thread.
   while (!data->ready) {
     uv_cond_wait(&data->cond, &data->mutex);
@@ -199,6 +334,7 @@ static void ui_bridge_option_set(UI *ui, String name, Object value)
   *copy_value = copy_object(value);
   UI_BRIDGE_CALL(ui, option_set, 4, ui, copy_name.data,
                  INT2PTR(copy_name.size), copy_value);
+  ui_bridge_wake((UIBridgeData *)ui);
   // TODO(bfredl): when/if TUI/bridge teardown is refactored to use events, the
   // commit that introduced this special case can be reverted.
   // For now this is needed for nvim_list_uis().
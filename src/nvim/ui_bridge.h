@@ -6,8 +6,20 @@
 #include <uv.h>
 
 #include "nvim/event/defs.h"
+#include "nvim/lib/kvec.h"
 #include "nvim/ui.h"
 
+// Capacity of the event ring, must be a power of two.
+#define UI_BRIDGE_RING_SIZE 4096
+// Capacity of the ring for event payloads (raw_line cells and attributes).
+#define UI_BRIDGE_PAYLOAD_SIZE (2 * 1024 * 1024)
+
+typedef struct {
+  Event event;
+  size_t payload_end;  // payload ring position after the data of this event
+  void *heap;          // payload too large for the ring, freed after the event
+} UIBridgeEvent;
+
 typedef struct ui_bridge_data UIBridgeData;
 typedef void (*ui_main_fn)(UIBridgeData *bridge, UI *ui);
 struct ui_bridge_data {
@@ -27,6 +39,21 @@ struct ui_bridge_data {
   // thread finishes handling all events. This flag is set by the UI thread as a
   // signal that it will no longer send messages to the main thread.
   bool stopped;
+  // Events are passed to the UI thread through a single-producer (main
+  // thread), single-consumer (UI thread) ring. The `*_write` positions are
+  // only written by the main thread, the `*_read` positions only by the UI
+  // thread. The UI thread is woken up once per flush. The main thread never
+  // waits for the UI thread, which may itself wait for the main thread to
+  // take its input.
+  UIBridgeEvent *ring;
+  size_t ring_write, ring_read;
+  char *payload;
+  size_t payload_write, payload_read;
+  void *pending_heap;  // heap payload of the next event
+  // Events that didn't fit in the full ring, protected by `mutex`. They are
+  // processed before any event pushed to the ring after them.
+  kvec_t(UIBridgeEvent) overflow;
+  size_t overflowing;  // `overflow` is not empty, written under `mutex`
 };
 
 #define CONTINUE(b) \
@@ -0,0 +1,67 @@
+-- Benchmarks passing job output to on_stdout callbacks.
+--
+-- A job cats a file of 64 MB, the callback only looks at the size of the
+-- data. Compares data_mode "lines" and "bytes", for Vimscript and Lua
+-- callbacks, and reports MB/s.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua, source, eval = helpers.clear, helpers.exec_lua, helpers.source, helpers.eval
+
+local SIZE = 64 * 1024 * 1024
+local LEN = 80
+
+describe('job output', function()
+  local filename
+
+  setup(function()
+    filename = helpers.tmpname()
+    local f = assert(io.open(filename, 'wb'))
+    local line = ('x'):rep(LEN - 1) .. '\n'
+    local chunk = line:rep(1024)
+    for _ = 1, SIZE / #chunk do
+      f:write(chunk)
+    end
+    f:close()
+  end)
+
+  teardown(function()
+    os.remove(filename)
+  end)
+
+  before_each(clear)
+
+  local function report(elapsed)
+    print(string.format('\n%.1f MB/s', SIZE / elapsed / (1024 * 1024)))
+  end
+
+  for _, mode in ipairs({'lines', 'bytes'}) do
+    it(string.format('to a Vimscript function, data_mode "%s"', mode), function()
+      source(string.format([[
+        function! OnStdout(id, data, event)
+          let g:n += len(a:data)
+        endfunction
+        let g:n = 0
+        let g:start = reltime()
+        call jobwait([jobstart(['cat', '%s'], {'data_mode': '%s', 'on_stdout': 'OnStdout'})])
+        let g:elapsed = reltimefloat(reltime(g:start))
+      ]], filename, mode))
+      report(eval('g:elapsed'))
+    end)
+
+    it(string.format('to a Lua function, data_mode "%s"', mode), function()
+      report(exec_lua([[
+        local filename, mode = ...
+        local n = 0
+        local start = vim.loop.hrtime()
+        local job = vim.fn.jobstart({'cat', filename}, {
+          data_mode = mode,
+          on_stdout = function(_, data)
+            n = n + #data
+          end,
+        })
+        vim.fn.jobwait({job})
+        return (vim.loop.hrtime() - start) / 1e9
+      ]], filename, mode))
+    end)
+  end
+end)
@@ -0,0 +1,46 @@
+-- Benchmarks starting jobs while a large buffer is loaded.
+--
+-- Starts 1000 jobs one after another, each waited for with jobwait(), with
+-- an empty buffer and with a buffer of 2 GB (set NVIM_BENCH_BUFFER_MB to
+-- change the size). Reports jobs/s and the mean time of jobstart().
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, command, exec_lua = helpers.clear, helpers.command, helpers.exec_lua
+
+local N = 1000
+local BUFFER_MB = tonumber(os.getenv('NVIM_BENCH_BUFFER_MB')) or 2048
+
+describe('jobstart()', function()
+  before_each(function()
+    clear()
+    command('set noswapfile undolevels=-1')
+  end)
+
+  for _, mb in ipairs({0, BUFFER_MB}) do
+    it(string.format('%d times with a buffer of %d MB', N, mb), function()
+      local rv = exec_lua([[
+        local n, mb = ...
+        -- 1024 lines of 1 KB per MB, added in batches of 16 MB.
+        local lines = {}
+        for i = 1, 16 * 1024 do
+          lines[i] = ('x'):rep(1023)
+        end
+        for _ = 1, mb / 16 do
+          vim.api.nvim_buf_set_lines(0, -1, -1, true, lines)
+        end
+
+        local spawn = 0
+        local start = vim.loop.hrtime()
+        for _ = 1, n do
+          local t = vim.loop.hrtime()
+          local job = vim.fn.jobstart({'true'})
+          spawn = spawn + vim.loop.hrtime() - t
+          assert(job > 0)
+          vim.fn.jobwait({job})
+        end
+        return {(vim.loop.hrtime() - start) / 1e9, spawn / n / 1e3}
+      ]], N, mb)
+      print(string.format('\n%.1f jobs/s, jobstart(): %.1f us', N / rv[1], rv[2]))
+    end)
+  end
+end)
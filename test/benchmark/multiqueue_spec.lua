@@ -0,0 +1,32 @@
+-- Benchmarks the event queue of the main loop.
+--
+-- Schedules a million callbacks with vim.schedule() in batches of 100, each
+-- batch processed before the next one is scheduled, and reports events/s.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua = helpers.clear, helpers.exec_lua
+
+local N = 1000000
+
+describe('event queue', function()
+  before_each(clear)
+
+  it(string.format('%d events', N), function()
+    local elapsed = exec_lua([[
+      local n = ...
+      local done = 0
+      local function cb()
+        done = done + 1
+      end
+      local start = vim.loop.hrtime()
+      for i = 1, n, 100 do
+        for _ = 1, 100 do
+          vim.schedule(cb)
+        end
+        vim.wait(10000, function() return done >= i + 99 end, 0)
+      end
+      return (vim.loop.hrtime() - start) / 1e9
+    ]], N)
+    print(string.format('\n%.1f million events/s', N / elapsed / 1e6))
+  end)
+end)
@@ -0,0 +1,45 @@
+-- Benchmark for bracketed paste throughput of the TUI.
+--
+-- Pastes blobs of increasing size into a TUI nvim running inside :terminal and
+-- reports MB/s, measured until the last line arrived in the child's buffer.
+
+local helpers = require('test.functional.helpers')(after_each)
+local thelpers = require('test.functional.terminal.helpers')
+local luv = require('luv')
+local clear, retry, eq = helpers.clear, helpers.retry, helpers.eq
+local nvim_prog, nvim_set = helpers.nvim_prog, helpers.nvim_set
+
+-- 80 bytes per line.
+local line = ('x'):rep(79)..'\n'
+
+describe('TUI paste', function()
+  local child_session
+
+  before_each(function()
+    clear()
+    local child_server = helpers.new_pipename()
+    thelpers.screen_setup(0,
+      string.format([=[["%s", "--listen", "%s", "-u", "NONE", "-i", "NONE", "--cmd", "%s noswapfile undolevels=1"]]=],
+        nvim_prog, child_server, nvim_set))
+    child_session = helpers.connect(child_server)
+    retry(nil, nil, function()
+      local _, m = child_session:request('nvim_get_mode')
+      eq('n', m.mode)
+    end)
+  end)
+
+  for _, mb in ipairs({1, 8, 32}) do
+    it(mb..' MB', function()
+      local nlines = mb * 1024 * 1024 / #line
+      thelpers.feed_data('i')
+      local start = luv.hrtime()
+      thelpers.feed_data('\027[200~'..line:rep(nlines)..'\027[201~')
+      retry(nil, 600000, function()
+        local _, count = child_session:request('nvim_buf_line_count', 0)
+        eq(nlines + 1, count)
+      end)
+      local elapsed = (luv.hrtime() - start) / 1e9
+      print(string.format('\n%d MB: %.2f s, %.2f MB/s', mb, elapsed, mb / elapsed))
+    end)
+  end
+end)
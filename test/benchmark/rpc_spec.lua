@@ -0,0 +1,64 @@
+-- Benchmarks for decoding large RPC requests and serializing large
+-- responses.
+--
+-- Sends nvim_buf_set_lines() and nvim_buf_get_lines() with 100k lines and
+-- reports requests/s and the MB/s of line data.
+
+local helpers = require('test.functional.helpers')(after_each)
+local luv = require('luv')
+local clear, command, meths, eq = helpers.clear, helpers.command, helpers.meths, helpers.eq
+
+local N = 100000
+local REPEAT = 10
+
+local function report(elapsed, bytes)
+  print(string.format('\n%.1f requests/s, %.1f MB/s',
+                      REPEAT / elapsed, bytes / elapsed / (1024 * 1024)))
+end
+
+local function make_lines(len)
+  local lines = {}
+  for i = 1, N do
+    lines[i] = (string.char(97 + i % 26)):rep(len)
+  end
+  return lines
+end
+
+describe('nvim_buf_set_lines() over RPC', function()
+  before_each(function()
+    clear()
+    command('set noswapfile undolevels=-1')
+  end)
+
+  for _, len in ipairs({10, 80, 400}) do
+    it(string.format('%d lines of %d bytes', N, len), function()
+      local lines = make_lines(len)
+      local start = luv.hrtime()
+      for _ = 1, REPEAT do
+        meths.buf_set_lines(0, 0, -1, true, lines)
+      end
+      local elapsed = (luv.hrtime() - start) / 1e9
+      eq(N, meths.buf_line_count(0))
+      report(elapsed, REPEAT * N * len)
+    end)
+  end
+end)
+
+describe('nvim_buf_get_lines() over RPC', function()
+  before_each(function()
+    clear()
+    command('set noswapfile undolevels=-1')
+  end)
+
+  for _, len in ipairs({10, 80, 400}) do
+    it(string.format('%d lines of %d bytes', N, len), function()
+      meths.buf_set_lines(0, 0, -1, true, make_lines(len))
+      local start = luv.hrtime()
+      for _ = 1, REPEAT do
+        eq(N, #meths.buf_get_lines(0, 0, -1, true))
+      end
+      local elapsed = (luv.hrtime() - start) / 1e9
+      report(elapsed, REPEAT * N * len)
+    end)
+  end
+end)
@@ -0,0 +1,56 @@
+-- Benchmarks the shared memory transport of local RPC connections against
+-- the socket.
+--
+-- A second nvim connects to the test instance with sockconnect() and reports
+-- the round trip time of small requests, and the MB/s of nvim_buf_get_lines()
+-- with 100k lines.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, command, meths, funcs = helpers.clear, helpers.command, helpers.meths, helpers.funcs
+local spawn, merge_args, exec_lua = helpers.spawn, helpers.merge_args, helpers.exec_lua
+local get_session, set_session = helpers.get_session, helpers.set_session
+
+local N = 10000
+local LINES = 100000
+local LEN = 80
+local REPEAT = 10
+
+describe('RPC over a local socket', function()
+  local server
+  before_each(function()
+    clear()
+    server = get_session()
+    command('set noswapfile undolevels=-1')
+    local lines = {}
+    for i = 1, LINES do
+      lines[i] = (string.char(97 + i % 26)):rep(LEN)
+    end
+    meths.buf_set_lines(0, 0, -1, true, lines)
+  end)
+
+  for _, shm in ipairs({false, true}) do
+    it(shm and 'with shared memory' or 'with the socket', function()
+      local address = funcs.serverlist()[1]
+      local client = spawn(merge_args(helpers.nvim_argv, {'--headless'}), false, nil, true)
+      set_session(client)
+      local rv = exec_lua([[
+        local address, shm, n, nrepeat = ...
+        local id = vim.fn.sockconnect('pipe', address, {rpc=true, shm=shm})
+        local start = vim.loop.hrtime()
+        for _ = 1, n do
+          vim.rpcrequest(id, 'nvim_eval', '1')
+        end
+        local latency = (vim.loop.hrtime() - start) / n / 1e3
+        start = vim.loop.hrtime()
+        for _ = 1, nrepeat do
+          vim.rpcrequest(id, 'nvim_buf_get_lines', 0, 0, -1, true)
+        end
+        return {latency, (vim.loop.hrtime() - start) / 1e9}
+      ]], address, shm, N, REPEAT)
+      client:close()
+      set_session(server)
+      print(string.format('\nround trip: %.1f us, nvim_buf_get_lines(): %.1f MB/s',
+                          rv[1], REPEAT * LINES * LEN / rv[2] / (1024 * 1024)))
+    end)
+  end
+end)
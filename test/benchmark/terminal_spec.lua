@@ -0,0 +1,51 @@
+-- Benchmark for :terminal throughput.
+--
+-- Runs `cat` on a large file inside :terminal and reports MB/s together with
+-- the terminal counters from nvim__stats().
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, command, eval = helpers.clear, helpers.command, helpers.eval
+local retry, eq, ok = helpers.retry, helpers.eq, helpers.ok
+local write_file = helpers.write_file
+local meths = helpers.meths
+
+local fname = 'Xterminal_bench.txt'
+
+local function make_file(mb)
+  local line = string.rep('abcdefghijklmnopqrstuvwxyz0123456789', 2)..'\n'
+  local count = math.floor(mb * 1024 * 1024 / #line)
+  write_file(fname, string.rep(line, count))
+  return count * #line
+end
+
+describe(':terminal throughput', function()
+  before_each(clear)
+
+  after_each(function()
+    os.remove(fname)
+  end)
+
+  for _, mb in ipairs({1, 8, 32}) do
+    it(string.format('cat %d MB', mb), function()
+      local size = make_file(mb)
+      local before = meths._stats()
+      command('let g:start = reltime()')
+      command('terminal cat '..fname)
+      local job = eval('b:terminal_job_id')
+      retry(nil, 60000, function()
+        eq({0}, eval('jobwait(['..job..'], 0)'))
+      end)
+      -- Output may still be queued after the process has exited. The pty
+      -- turns every NL into CR NL, so at least `size` bytes are expected.
+      retry(nil, 60000, function()
+        ok(meths._stats().term_bytes - before.term_bytes >= size)
+      end)
+      local elapsed = eval('reltimefloat(reltime(g:start))')
+      local after = meths._stats()
+      print(string.format('\n%d MB: %.1f MB/s, %d refreshes, %d damage rows',
+                          mb, mb / elapsed,
+                          after.term_refreshes - before.term_refreshes,
+                          after.term_damage - before.term_damage))
+    end)
+  end
+end)
@@ -0,0 +1,60 @@
+-- Benchmark for the number of bytes the TUI writes to the host terminal.
+--
+-- Replays a fixed redraw trace (scrolling through a syntax-highlighted file)
+-- in a TUI nvim running inside :terminal, and reports the bytes written per
+-- frame as counted by nvim__stats().
+
+local helpers = require('test.functional.helpers')(after_each)
+local thelpers = require('test.functional.terminal.helpers')
+local clear, retry, eq, sleep = helpers.clear, helpers.retry, helpers.eq, helpers.sleep
+local nvim_prog, nvim_set = helpers.nvim_prog, helpers.nvim_set
+
+local sample_file = 'src/nvim/tui/tui.c'
+
+-- Each entry is sent with nvim_input() and waited on before the next one.
+local trace = {
+  { name = 'line scroll', keys = '<C-e>', count = 200 },
+  { name = 'page scroll', keys = '<C-f>', count = 40 },
+  { name = 'half page up', keys = '<C-u>', count = 40 },
+  { name = 'cursor down', keys = 'j', count = 200 },
+}
+
+describe('TUI output', function()
+  local child_session
+
+  setup(function()
+    clear()
+    local child_server = helpers.new_pipename()
+    thelpers.screen_setup(18,
+      string.format([=[["%s", "--listen", "%s", "-u", "NONE", "-i", "NONE", "--cmd", "%s laststatus=2 background=dark", "--cmd", "syntax on", "%s"]]=],
+        nvim_prog, child_server, nvim_set, sample_file), 80)
+    child_session = helpers.connect(child_server)
+    retry(nil, nil, function()
+      local _, name = child_session:request('nvim_eval', 'bufname()')
+      eq(sample_file, name)
+    end)
+  end)
+
+  local function stats()
+    local _, s = child_session:request('nvim__stats')
+    return s
+  end
+
+  for _, step in ipairs(trace) do
+    it(step.name, function()
+      local before = stats()
+      for _ = 1, step.count do
+        child_session:request('nvim_input', step.keys)
+        -- Round-trip so that every key becomes its own frame.
+        child_session:request('nvim_eval', '1')
+      end
+      -- Let the TUI thread write the last frame.
+      sleep(100)
+      local after = stats()
+      local bytes = after.tui_bytes - before.tui_bytes
+      local writes = after.tui_writes - before.tui_writes
+      print(string.format('\n%s: %d bytes, %d writes, %.1f bytes/frame',
+                          step.name, bytes, writes, bytes / writes))
+    end)
+  end
+end)
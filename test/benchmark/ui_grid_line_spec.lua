@@ -0,0 +1,62 @@
+-- Benchmark for the size of "grid_line" vs "grid_line_binary" events.
+--
+-- Replays the same redraw trace (scrolling through a syntax-highlighted file)
+-- with and without ext_grid_binary, and reports the msgpack-encoded size of
+-- the grid line events received by the UI.
+
+local helpers = require('test.functional.helpers')(after_each)
+local Screen = require('test.functional.ui.screen')
+local mpack = require('mpack')
+local clear, command, feed = helpers.clear, helpers.command, helpers.feed
+local poke_eventloop = helpers.poke_eventloop
+
+local sample_file = 'src/nvim/tui/tui.c'
+
+local trace = {
+  { keys = '<C-e>', count = 200 },
+  { keys = '<C-f>', count = 40 },
+  { keys = '<C-u>', count = 40 },
+}
+
+local function replay(binary)
+  clear()
+  local screen = Screen.new(120, 40)
+  local bytes, events = 0, 0
+  local function count(...)
+    bytes = bytes + #mpack.encode({...})
+    events = events + 1
+  end
+  function screen:_handle_grid_line(...)
+    count(...)
+    Screen._handle_grid_line(self, ...)
+  end
+  function screen:_handle_grid_line_binary(...)
+    count(...)
+    Screen._handle_grid_line_binary(self, ...)
+  end
+  screen:attach({rgb=true, ext_grid_binary=binary})
+  command('syntax on')
+  command('edit '..sample_file)
+  poke_eventloop()
+  screen:sleep(100)
+  bytes, events = 0, 0
+  for _, step in ipairs(trace) do
+    for _ = 1, step.count do
+      feed(step.keys)
+      poke_eventloop()
+    end
+  end
+  screen:sleep(100)
+  screen:detach()
+  return bytes, events
+end
+
+describe('grid_line events', function()
+  it('size with and without ext_grid_binary', function()
+    local plain, plain_events = replay(false)
+    local packed, packed_events = replay(true)
+    print(string.format('\ngrid_line: %d bytes in %d events', plain, plain_events))
+    print(string.format('grid_line_binary: %d bytes in %d events (%.1f%%)',
+                        packed, packed_events, 100 * packed / plain))
+  end)
+end)
@@ -0,0 +1,62 @@
+-- Benchmarks writing many small RPC notifications to a channel.
+--
+-- The test instance sends notifications to a child nvim, either all at once
+-- ("burst", queued buffers are written with one writev()) or one per loop
+-- iteration ("paced", one write each, like before the writes were
+-- coalesced). Reports notifications/s, MB/s and write requests/s.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua, funcs = helpers.clear, helpers.exec_lua, helpers.funcs
+
+local N = 100000
+
+describe('RPC notifications', function()
+  local chan
+  before_each(function()
+    clear()
+    chan = funcs.jobstart({helpers.nvim_prog, '-u', 'NONE', '--embed', '--headless'},
+                          {rpc=true})
+  end)
+
+  after_each(function()
+    funcs.jobstop(chan)
+  end)
+
+  for _, paced in ipairs({false, true}) do
+    for _, len in ipairs({10, 1000}) do
+      it(string.format('%s, %d bytes', paced and 'paced' or 'burst', len), function()
+        local rv = exec_lua([[
+          local chan, n, len, paced = ...
+          local payload = ('x'):rep(len)
+          local before = vim.api.nvim_get_chan_info(chan).stats
+          local start = vim.loop.hrtime()
+          if paced then
+            local i = 0
+            local function send()
+              i = i + 1
+              vim.rpcnotify(chan, 'nvim_set_var', 'x', payload)
+              if i < n then
+                vim.schedule(send)
+              end
+            end
+            send()
+            vim.wait(60000, function() return i == n end, 0)
+          else
+            for _ = 1, n do
+              vim.rpcnotify(chan, 'nvim_set_var', 'x', payload)
+            end
+          end
+          -- Waits until the child handled everything.
+          vim.rpcrequest(chan, 'nvim_eval', '1')
+          local elapsed = (vim.loop.hrtime() - start) / 1e9
+          local after = vim.api.nvim_get_chan_info(chan).stats
+          return {elapsed, after.writes - before.writes, after.bytes_out - before.bytes_out}
+        ]], chan, N, len, paced)
+        local elapsed, writes, bytes = unpack(rv)
+        print(string.format('\n%.1f notifications/s, %.1f MB/s, %.1f writes/s, %.1f per write',
+                            N / elapsed, bytes / elapsed / (1024 * 1024),
+                            writes / elapsed, N / writes))
+      end)
+    end
+  end
+end)
@@ -4,6 +4,7 @@ local clear, nvim, buffer = helpers.clear, helpers.nvim, helpers.buffer
 local curbuf, curwin, eq = helpers.curbuf, helpers.curwin, helpers.eq
 local curbufmeths, ok = helpers.curbufmeths, helpers.ok
 local meths = helpers.meths
+local async_meths = helpers.async_meths
 local funcs = helpers.funcs
 local request = helpers.request
 local exc_exec = helpers.exc_exec
@@ -14,6 +15,7 @@ local command = helpers.command
 local bufmeths = helpers.bufmeths
 local feed = helpers.feed
 local pcall_err = helpers.pcall_err
+local exec_lua = helpers.exec_lua
 
 describe('api/buf', function()
   before_each(clear)
@@ -224,6 +226,36 @@ describe('api/buf', function()
       eq({''}, get_lines(0, 1, true))
     end)
 
+    it('gets lines set by earlier notifications', function()
+      -- get_lines is |api-readonly| and may be served without waiting for
+      -- the main loop, but not before pending requests of the channel.
+      for i = 1, 20 do
+        async_meths.buf_set_lines(0, 0, -1, true, {'line'..i})
+        eq({'line'..i}, get_lines(0, -1, true))
+      end
+      command('startinsert')
+      async_meths.buf_set_lines(0, 0, -1, true, {'a', 'b'})
+      eq({'a', 'b'}, get_lines(0, -1, true))
+      eq({1, 0}, meths.win_get_cursor(0))
+    end)
+
+    it('gets lines set by a callback scheduled before the request', function()
+      async_meths.exec_lua([[
+        local timer = vim.loop.new_timer()
+        timer:start(0, 0, function()
+          timer:close()
+          vim.schedule(function()
+            vim.api.nvim_buf_set_lines(0, 0, -1, true, {'scheduled'})
+          end)
+        end)
+        -- The timer fires when the main loop polls next, just before the
+        -- request sent meanwhile is read.
+        vim.loop.sleep(200)
+      ]], {})
+      helpers.sleep(50)
+      eq({'scheduled'}, get_lines(0, -1, true))
+    end)
+
     it('can get a single line with strict indexing', function()
       set_lines(0, 1, true, {'line1.a'})
       eq(1, line_count()) -- sanity
@@ -537,6 +569,30 @@ describe('api/buf', function()
     end)
   end)
 
+  describe('nvim_get_text_batch', function()
+    it('gets ranges of several buffers', function()
+      local b1 = meths.get_current_buf()
+      meths.buf_set_lines(b1, 0, -1, true, {'a', 'b', 'c\0d', 'e'})
+      local b2 = meths.create_buf(false, true)
+      meths.buf_set_lines(b2, 0, -1, true, {'x', '', 'z'})
+      eq({{'c\0d\ne\n', 'a\nb\n', ''}, {'x\n\nz\n'}},
+         meths.get_text_batch({{b1, {{2, -1}, {0, 2}, {1, 1}}}, {b2, {{-10, 10}}}}))
+      eq({{'z\n'}}, exec_lua([[
+        local buf = ...
+        return vim.api.nvim_get_text_batch({{buf, {{2, 3}}}})
+      ]], b2))
+    end)
+
+    it('validates its arguments', function()
+      eq('Invalid buffer id: 99',
+         pcall_err(meths.get_text_batch, {{99, {{0, 1}}}}))
+      eq('Range 0 of request 0 must be an array of two integers',
+         pcall_err(meths.get_text_batch, {{0, {{0}}}}))
+      eq('Request 0 must be an array of a buffer and ranges',
+         pcall_err(meths.get_text_batch, {{0}}))
+    end)
+  end)
+
   describe('nvim_buf_get_offset', function()
     local get_offset = curbufmeths.get_offset
     it('works', function()
@@ -276,22 +276,25 @@ describe('server -> client', function()
 
   describe('connecting to another (peer) nvim', function()
     local nvim_argv = merge_args(helpers.nvim_argv, {'--headless'})
-    local function connect_test(server, mode, address)
+    local function connect_test(server, mode, address, opts)
       local serverpid = funcs.getpid()
       local client = spawn(nvim_argv, false, nil, true)
       set_session(client)
 
       local clientpid = funcs.getpid()
       neq(serverpid, clientpid)
-      local id = funcs.sockconnect(mode, address, {rpc=true})
+      local id = funcs.sockconnect(mode, address, opts or {rpc=true})
       ok(id > 0)
 
       funcs.rpcrequest(id, 'nvim_set_current_line', 'hello')
       local client_id = funcs.rpcrequest(id, 'nvim_get_api_info')[1]
+      local shm = (opts and opts.shm) or false
+      eq(shm, meths.get_chan_info(id).stats.shm)
 
       set_session(server)
       eq(serverpid, funcs.getpid())
       eq('hello', meths.get_current_line())
+      eq(shm, meths.get_chan_info(client_id).stats.shm)
 
       -- method calls work both ways
       funcs.rpcrequest(client_id, 'nvim_set_current_line', 'howdy!')
@@ -314,6 +317,28 @@ describe('server -> client', function()
       connect_test(server, 'pipe', address)
     end)
 
+    it('via named pipe and shared memory', function()
+      if helpers.pending_win32(pending) then return end
+      local server = spawn(nvim_argv)
+      set_session(server)
+      local address = funcs.serverlist()[1]
+      connect_test(server, 'pipe', address, {rpc=true, shm=true})
+
+      -- messages larger than the rings
+      server = spawn(nvim_argv)
+      set_session(server)
+      address = funcs.serverlist()[1]
+      local client = spawn(nvim_argv, false, nil, true)
+      set_session(client)
+      local id = funcs.sockconnect('pipe', address, {rpc=true, shm=true})
+      eq(true, meths.get_chan_info(id).stats.shm)
+      local line = string.rep('x', 3 * 1024 * 1024)
+      funcs.rpcrequest(id, 'nvim_set_current_line', line)
+      eq(line, funcs.rpcrequest(id, 'nvim_get_current_line'))
+      server:close()
+      client:close()
+    end)
+
     it('via ipv4 address', function()
       local server = spawn(nvim_argv)
       set_session(server)
@@ -1,4 +1,5 @@
 local helpers = require('test.functional.helpers')(after_each)
+local luv = require('luv')
 local Screen = require('test.functional.ui.screen')
 local clear = helpers.clear
 local eq = helpers.eq
@@ -34,6 +35,51 @@ describe('nvim_ui_attach()', function()
     eq('UI already attached to channel: 1',
       pcall_err(request, 'nvim_ui_attach', 40, 10, { rgb=false }))
   end)
+
+  it('runs nvim_ui_try_resize after an nvim_ui_attach sent before it', function()
+    -- Sent without waiting for a reply, both are queued at the same time.
+    helpers.nvim_async('ui_attach', 40, 10, {})
+    helpers.nvim_async('ui_try_resize', 50, 12)
+    local ui = meths.list_uis()[1]
+    eq(50, ui.width)
+    eq(12, ui.height)
+  end)
+
+  it('sends events with arguments to every UI', function()
+    local screen = Screen.new(20, 4)
+    screen:attach({ext_popupmenu=true})
+    local screen2 = Screen.new(20, 4)
+    screen2:attach({ext_popupmenu=true}, helpers.connect(eval('v:servername')))
+    helpers.command([[inoremap <F2> <Cmd>call complete(col('.'), ['foo', 'bar'])<CR>]])
+    helpers.feed('i<F2>')
+    local items = {{'foo', '', '', ''}, {'bar', '', '', ''}}
+    for _, s in ipairs({screen, screen2}) do
+      s:expect{condition=function()
+        eq(items, (s.popupmenu or {}).items)
+      end}
+    end
+    helpers.assert_alive()
+  end)
+
+  it('refreshes a UI that missed redraw events because of lag_limit', function()
+    local screen = Screen.new(40, 6)
+    screen:attach({lag_limit=1000})
+    -- The client doesn't read while it sleeps, so the output fills the pipe
+    -- and Nvim drops frames.
+    helpers.nvim_async('command',
+      [[for i in range(1, 2000) | call setline(1, repeat([repeat(i .. ' ', 8)], 5)) | redraw | endfor]])
+    luv.sleep(500)
+    screen:expect([[
+      ^2000 2000 2000 2000 2000 2000 2000 2000 |
+      2000 2000 2000 2000 2000 2000 2000 2000 |
+      2000 2000 2000 2000 2000 2000 2000 2000 |
+      2000 2000 2000 2000 2000 2000 2000 2000 |
+      2000 2000 2000 2000 2000 2000 2000 2000 |
+                                              |
+    ]])
+    local ui = meths.list_uis()[1]
+    helpers.ok(ui.frames_dropped > 0)
+  end)
 end)
 
 it('autocmds UIEnter/UILeave', function()
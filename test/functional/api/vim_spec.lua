@@ -1538,6 +1538,15 @@ describe('API', function()
       id = 2,
       mode = 'bytes',
     }
+    -- "stats" of RPC channels changes with each request, see below.
+    local function get_chan_info(id)
+      local info = meths.get_chan_info(id)
+      if info.mode == 'rpc' then
+        eq('table', type(info.stats))
+        info.stats = nil
+      end
+      return info
+    end
 
     it('returns {} for invalid channel', function()
       eq({}, meths.get_chan_info(0))
@@ -1548,7 +1557,7 @@ describe('API', function()
 
     it('stream=stdio channel', function()
       eq({[1]=testinfo,[2]=stderr}, meths.list_chans())
-      eq(testinfo, meths.get_chan_info(1))
+      eq(testinfo, get_chan_info(1))
       eq(stderr, meths.get_chan_info(2))
 
       meths.set_client_info("functionaltests",
@@ -1570,7 +1579,7 @@ describe('API', function()
       }
       eq({info=info}, meths.get_var("info_event"))
       eq({[1]=info, [2]=stderr}, meths.list_chans())
-      eq(info, meths.get_chan_info(1))
+      eq(info, get_chan_info(1))
     end)
 
     it('stream=job channel', function()
@@ -1585,7 +1594,7 @@ describe('API', function()
       }
       eq({info=info}, meths.get_var("opened_event"))
       eq({[1]=testinfo,[2]=stderr,[3]=info}, meths.list_chans())
-      eq(info, meths.get_chan_info(3))
+      eq(info, get_chan_info(3))
       eval('rpcrequest(3, "nvim_set_client_info", "amazing-cat", {}, "remote",'..
                        '{"nvim_command":{"n_args":1}},'.. -- and so on
                        '{"description":"The Amazing Cat"})')
@@ -1630,7 +1639,7 @@ describe('API', function()
       eq({info=info}, event)
       info.buffer = {id=1}
       eq({[1]=testinfo,[2]=stderr,[3]=info}, meths.list_chans())
-      eq(info, meths.get_chan_info(3))
+      eq(info, get_chan_info(3))
 
       -- :terminal with args + running process.
       command(':exe "terminal" shellescape(v:progpath) "-u NONE -i NONE"')
@@ -1664,6 +1673,72 @@ describe('API', function()
       expected2.pty = (iswin() and '?' or '')  -- pty stream was closed.
       eq(expected2, eval('nvim_get_chan_info(&channel)'))
     end)
+
+    it('counts RPC messages', function()
+      meths.get_current_line()
+      meths.set_current_line('x')
+      pcall(meths.set_current_buf, -1)
+      local stats = meths.get_chan_info(1).stats
+      ok(stats.requests >= 3)
+      ok(stats.bytes_in > 0)
+      ok(stats.bytes_out > 0)
+      ok(stats.writes > 0)
+      eq(0, stats.queue)
+      local method = stats.methods.nvim_set_current_buf
+      eq(1, method.calls)
+      eq(1, method.errors)
+      ok(#method.handle_hist > 0)
+      ok(#method.response_hist > 0)
+      eq(1, stats.methods.nvim_get_current_line.calls)
+      eq(nil, stats.methods.nvim_list_bufs)
+
+      local channels = meths._stats().rpc
+      eq(1, channels[1].id)
+      eq('table', type(channels[1].methods))
+    end)
+
+    it('writes a burst of messages with few write requests', function()
+      local writes = meths.get_chan_info(1).stats.writes
+      exec_lua([[
+        for i = 1, 1000 do
+          vim.rpcnotify(1, 'burst', i)
+        end
+      ]])
+      ok(meths.get_chan_info(1).stats.writes - writes < 100)
+    end)
+  end)
+
+  describe('nvim__event_stats', function()
+    it('times event handlers and input latency', function()
+      eq({enabled=false}, meths._stats().events)
+      meths._event_stats({enable=true, threshold=0})
+      exec_lua('vim.schedule(function() end)')
+      meths.input('ix<esc>')
+      helpers.retry(nil, nil, function()
+        ok(meths._stats().events.input_latency.count >= 1)
+      end)
+
+      local stats = meths._stats().events
+      eq(true, stats.enabled)
+      eq(0, stats.threshold)
+      local handler = stats.handlers.nlua_schedule_event
+      eq(1, handler.count)
+      eq(1, handler.slow)
+      ok(handler.max > 0)
+      ok(#stats.slow > 0)
+      ok(stats.input_latency.max > 0)
+
+      local fname = 'Xevent_stats.json'
+      meths._event_stats({dump=fname})
+      local dumped = funcs.json_decode(funcs.readfile(fname))
+      os.remove(fname)
+      eq(1, dumped.handlers.nlua_schedule_event.count)
+      eq(0, dumped.threshold)
+
+      meths._event_stats({enable=false})
+      eq({enabled=false}, meths._stats().events)
+      eq('unexpected key: foo', pcall_err(meths._event_stats, {foo=true}))
+    end)
   end)
 
   describe('nvim_call_atomic', function()
@@ -2032,6 +2107,17 @@ describe('API', function()
       -- Test runner defaults to --headless.
       eq({}, nvim("list_uis"))
     end)
+    -- Drops the lag metrics, which depend on timing.
+    local function list_uis()
+      local uis = nvim("list_uis")
+      for _, ui in ipairs(uis) do
+        for _, key in ipairs({'lag_bytes', 'lag_max_bytes', 'frames', 'frames_dropped'}) do
+          eq('number', type(ui[key]))
+          ui[key] = nil
+        end
+      end
+      return uis
+    end
     it('returns attached UIs', function()
       local screen = Screen.new(20, 4)
       screen:attach({override=true})
@@ -2046,23 +2132,32 @@ describe('API', function()
           ext_multigrid = false,
           ext_hlstate = false,
           ext_termcolors = false,
+          ext_grid_binary = false,
           ext_messages = false,
           height = 4,
           rgb = true,
           override = true,
           width = 20,
+          lag_limit = 4 * 1024 * 1024,
         }
       }
-      eq(expected, nvim("list_uis"))
+      eq(expected, list_uis())
 
       screen:detach()
       screen = Screen.new(44, 99)
-      screen:attach({ rgb = false })
+      screen:attach({ rgb = false, lag_limit = 0 })
       expected[1].rgb = false
       expected[1].override = false
       expected[1].width = 44
       expected[1].height = 99
-      eq(expected, nvim("list_uis"))
+      expected[1].lag_limit = 0
+      eq(expected, list_uis())
+    end)
+    it('validates lag_limit', function()
+      local screen = Screen.new(20, 4)
+      local status, rv = pcall(screen.attach, screen, {lag_limit=-1})
+      eq(false, status)
+      ok(nil ~= string.find(rv, 'lag_limit must be a non%-negative Integer'))
     end)
   end)
 
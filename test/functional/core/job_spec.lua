@@ -119,6 +119,42 @@ describe('jobs', function()
     end
   end)
 
+  it('finds the program in the PATH of the job #env', function()
+    if helpers.pending_win32(pending) then return end
+    local dir = 'Xjob_path'
+    mkdir(dir)
+    finally(function()
+      rmdir(dir)
+    end)
+    write_file(dir .. '/Xjob_sh', '#!/bin/sh\necho via Xjob_sh\nexec /bin/sh "$@"\n')
+    funcs.setfperm(dir .. '/Xjob_sh', 'rwx------')
+    nvim('command', 'set shell=Xjob_sh')
+    nvim('command', "let g:job_opts.env = {'PATH': getcwd() . '/" .. dir .. ":' . $PATH}")
+    nvim('command', [[call jobstart('echo hello', g:job_opts)]])
+    expect_msg_seq({
+      {'notification', 'stdout', {0, {'via Xjob_sh', 'hello', ''}}}
+    },
+    -- Alternative sequence: the output may arrive in two chunks.
+    {
+      {'notification', 'stdout', {0, {'via Xjob_sh', ''}}},
+      {'notification', 'stdout', {0, {'hello', ''}}},
+    })
+  end)
+
+  it('runs a script without "#!" with /bin/sh', function()
+    if helpers.pending_win32(pending) then return end
+    write_file('Xjob_noshebang', 'echo "no shebang: $1"\n')
+    finally(function()
+      os.remove('Xjob_noshebang')
+    end)
+    funcs.setfperm('Xjob_noshebang', 'rwx------')
+    nvim('command', "let j = jobstart(['./Xjob_noshebang', 'arg'], g:job_opts)")
+    expect_msg_seq({
+      {'notification', 'stdout', {0, {'no shebang: arg', ''}}}
+    })
+    eq(0, eval('jobwait([j])[0]'))
+  end)
+
   it('handles case-insensitively matching #env vars', function()
     nvim('command', "let $TOTO = 'abc'")
     -- Since $Toto is being set in the job, it should take precedence over the
@@ -651,6 +687,116 @@ describe('jobs', function()
     )
   end)
 
+  describe('with data_mode "bytes"', function()
+    local filename
+    before_each(function()
+      filename = helpers.tmpname()
+      write_file(filename, "abc\0def\n")
+    end)
+    after_each(function()
+      os.remove(filename)
+    end)
+
+    it('passes output as a Blob', function()
+      source(string.format([[
+        let g:job_opts = {'data_mode': 'bytes', 'stdout_buffered': v:true}
+        call jobwait([jobstart(['cat', '%s'], g:job_opts)])
+      ]], filename))
+      eq(10, eval('type(g:job_opts.stdout)'))
+      eq('abc\0def\n', eval('g:job_opts.stdout'))
+    end)
+
+    it('passes output to Lua functions as a string', function()
+      local rv = helpers.exec_lua([[
+        local chunks = {}
+        vim.fn.jobstart({'cat', ...}, {
+          data_mode = 'bytes',
+          on_stdout = function(_, data, name)
+            assert(type(data) == 'string' and name == 'stdout')
+            table.insert(chunks, data)
+          end,
+        })
+        vim.wait(10000, function() return chunks[#chunks] == '' end)
+        return table.concat(chunks)
+      ]], filename)
+      eq('abc\0def\n', rv)
+    end)
+
+    it('passes output to a Vimscript function given by name', function()
+      source(string.format([[
+        let g:out = 0z
+        let g:eof = v:false
+        function! OnStdout(id, data, event)
+          let g:out += a:data
+          let g:eof = empty(a:data)
+        endfunction
+        call jobwait([jobstart(['cat', '%s'], {'data_mode': 'bytes',
+              \ 'on_stdout': 'OnStdout'})])
+      ]], filename))
+      eq('abc\0def\n', eval('g:out'))
+      eq(true, eval('g:eof'))
+    end)
+
+    it('does not crash with the name of an undefined function', function()
+      local opts = "{'data_mode': 'bytes', 'on_stdout': 'Undefined'}"
+      pcall(command, string.format("call jobwait([jobstart(['cat', '%s'], %s)])", filename, opts))
+      assert_alive()
+    end)
+
+    it('fails with an invalid data_mode', function()
+      eq('Vim(call):E475: Invalid value for argument data_mode: foo',
+         pcall_err(command, "call jobstart(['cat'], {'data_mode': 'foo'})"))
+    end)
+  end)
+
+  describe('with throttle', function()
+    local filename
+    local size
+    before_each(function()
+      filename = helpers.tmpname()
+      local lines = {}
+      for i = 1, 100000 do
+        lines[i] = tostring(i)
+      end
+      local contents = table.concat(lines, '\n') .. '\n'
+      size = #contents
+      write_file(filename, contents)
+    end)
+    after_each(function()
+      os.remove(filename)
+    end)
+
+    it('skips output, but passes its end', function()
+      local rv = helpers.exec_lua([[
+        local chunks = {}
+        vim.fn.jobstart({'cat', ...}, {
+          data_mode = 'bytes',
+          throttle = 1000,
+          on_stdout = function(_, data)
+            table.insert(chunks, data)
+          end,
+        })
+        vim.wait(10000, function() return chunks[#chunks] == '' end)
+        return table.concat(chunks)
+      ]], filename)
+      ok(#rv < size)
+      eq('\n100000\n', rv:sub(-8))
+    end)
+
+    it('does not skip output of buffered readers', function()
+      source(string.format([[
+        let g:job_opts = {'data_mode': 'bytes', 'throttle': 1000, 'stdout_buffered': v:true}
+        call jobwait([jobstart(['cat', '%s'], g:job_opts)])
+      ]], filename))
+      eq(size, eval('len(g:job_opts.stdout)'))
+    end)
+
+    it('fails with a negative throttle', function()
+      eq('Vim(call):E475: Invalid value for argument throttle',
+         pcall_err(command, "call jobstart(['cat'], {'throttle': -1})"))
+    end)
+  end)
+
   describe('jobwait', function()
     before_each(function()
       if iswin() then
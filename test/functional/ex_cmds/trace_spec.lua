@@ -0,0 +1,80 @@
+local helpers = require('test.functional.helpers')(after_each)
+local clear, command, eq, ok = helpers.clear, helpers.command, helpers.eq, helpers.ok
+local exec_lua, funcs, source = helpers.exec_lua, helpers.funcs, helpers.source
+local matches, pcall_err, read_file = helpers.matches, helpers.pcall_err, helpers.read_file
+
+describe(':trace', function()
+  local tracefile = 'Xtrace.json'
+
+  before_each(clear)
+
+  after_each(function()
+    os.remove(tracefile)
+    os.remove('Xtrace_written')
+  end)
+
+  local function read_trace()
+    local events = funcs.json_decode(read_file(tracefile))
+    eq('process_name', events[1].name)
+    -- Every span must be closed, in the right order.
+    local open = {}
+    local spans = {}
+    for i = 2, #events do
+      local ev = events[i]
+      if ev.ph == 'B' then
+        table.insert(open, ev)
+        table.insert(spans, ev)
+      else
+        eq('E', ev.ph)
+        ok(#open > 0)
+        ok(ev.ts >= table.remove(open).ts)
+      end
+    end
+    eq(0, #open)
+    return spans
+  end
+
+  local function find(spans, cat, pattern)
+    for _, span in ipairs(spans) do
+      if span.cat == cat and span.name:match(pattern) then
+        return span
+      end
+    end
+    error(string.format('no %s span matching %s', cat, pattern))
+  end
+
+  it('writes spans in the Chrome trace event format', function()
+    source([[
+      function! TraceTest()
+        return 1
+      endfunction
+      autocmd User TraceTest call TraceTest()
+    ]])
+    command('trace start ' .. tracefile)
+    command('doautocmd User TraceTest')
+    command('write Xtrace_written')
+    exec_lua('vim.schedule(function() end)')
+    command('trace stop')
+
+    local spans = read_trace()
+    find(spans, 'loop', 'K_EVENT')
+    find(spans, 'rpc', '^nvim_command$')
+    find(spans, 'autocmd', '^User TraceTest$')
+    find(spans, 'function', '^TraceTest$')
+    find(spans, 'io', '^write .*Xtrace_written$')
+    find(spans, 'lua', '^vim.schedule callback$')
+  end)
+
+  it('is stopped on exit', function()
+    command('trace start ' .. tracefile)
+    command('qall!')
+    clear()
+    find(read_trace(), 'rpc', '^nvim_command$')
+  end)
+
+  it('fails with invalid arguments', function()
+    eq('Vim(trace):E475: Invalid argument: foo', pcall_err(command, 'trace foo'))
+    matches('E484: Can\'t open file Xtrace_missing/trace.json',
+            pcall_err(command, 'trace start Xtrace_missing/trace.json'))
+  end)
+end)
@@ -11,6 +11,7 @@ local exc_exec = helpers.exc_exec
 local matches = helpers.matches
 local exec_lua = helpers.exec_lua
 local sleep = helpers.sleep
+local ok, retry = helpers.ok, helpers.retry
 
 describe(':terminal buffer', function()
   local screen
@@ -297,6 +298,17 @@ describe(':terminal buffer', function()
     feed_command('put a')  -- register a is empty
     helpers.assert_alive()
   end)
+
+  it('counts output and refreshes in nvim__stats()', function()
+    local before = nvim('_stats')
+    thelpers.feed_data(('x'):rep(1000))
+    retry(nil, nil, function()
+      local stats = nvim('_stats')
+      ok(stats.term_bytes >= before.term_bytes + 1000)
+      ok(stats.term_refreshes > before.term_refreshes)
+      ok(stats.term_damage > before.term_damage)
+    end)
+  end)
 end)
 
 describe('No heap-buffer-overflow when using', function()
@@ -341,6 +341,36 @@ describe(':terminal scrollback', function()
       end)
     end)
   end)
+
+  describe('with more than 1000 lines', function()
+    before_each(function()
+      command('setlocal scrollback=2000')
+      thelpers.set_bold()
+      feed_data({'bold line', ''})
+      thelpers.clear_attrs()
+      local lines = {}
+      for i = 1, 1200 do
+        table.insert(lines, 'line'..tostring(i))
+      end
+      table.insert(lines, '')
+      feed_data(lines)
+      screen:expect{any='line1200'}
+    end)
+
+    it('keeps the text and attributes of old lines', function()
+      feed('<c-\\><c-n>gg')
+      screen:expect([[
+        ^tty ready                     |
+        {3:bold line}                     |
+        line1                         |
+        line2                         |
+        line3                         |
+        line4                         |
+                                      |
+      ]])
+      eq(1203, curbuf('line_count'))
+    end)
+  end)
 end)
 
 describe(':terminal prints more lines than the screen height and exits', function()
@@ -463,6 +493,35 @@ describe("'scrollback' option", function()
     eq((iswin() and '27: line' or '26: line'), eval("getline(line('w0') - 10)"))
   end)
 
+  it('keeps the newest lines when reduced on a full scrollback', function()
+    local screen
+    if iswin() then
+      command([[let $PROMPT='$$']])
+      screen = thelpers.screen_setup(nil, "['cmd.exe']", 30)
+    else
+      command('let $PS1 = "$"')
+      screen = thelpers.screen_setup(nil, "['sh']", 30)
+    end
+
+    curbufmeths.set_option('scrollback', 20)
+    screen:expect{any='%$'}
+    feed_data(nvim_dir.."/shell-test REP 51 line"..(iswin() and '\r' or '\n'))
+    screen:expect{any='50: line                      '}
+    -- The scrollback is full: the newest 20 lines above the screen remain.
+    retry(nil, nil, function() eq(20, eval("line('w0') - 1")) end)
+    local kept = eval("getline(line('w0') - 5, line('w0') - 1)")
+
+    curbufmeths.set_option('scrollback', 5)
+    retry(nil, nil, function() eq(5, eval("line('w0') - 1")) end)
+    eq(kept, eval("getline(1, line('w0') - 1)"))
+
+    -- The smaller scrollback still works.
+    feed_data(nvim_dir.."/shell-test REP 11 more"..(iswin() and '\r' or '\n'))
+    screen:expect{any='10: more                      '}
+    retry(nil, nil, function() eq(5, eval("line('w0') - 1")) end)
+    assert_alive()
+  end)
+
   it('defaults to 10000 in :terminal buffers', function()
     set_fake_shell()
     command('terminal')
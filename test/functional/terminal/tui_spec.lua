@@ -919,6 +919,35 @@ describe('TUI', function()
       {3:-- TERMINAL --}                                    |
     ]=])
   end)
+
+  it('counts terminal writes in nvim__stats()', function()
+    retry(nil, nil, function()
+      local _, stats = child_session:request('nvim__stats')
+      ok(stats.tui_writes > 0)
+      ok(stats.tui_frame_bytes > 0)
+      ok(stats.tui_bytes >= stats.tui_frame_bytes)
+    end)
+    local _, before = child_session:request('nvim__stats')
+    feed_data(':redraw!\r')
+    retry(nil, nil, function()
+      local _, stats = child_session:request('nvim__stats')
+      ok(stats.tui_writes > before.tui_writes)
+    end)
+  end)
+
+  it('does not hang when the UI bridge is full while input is pending', function()
+    -- Each 'linespace' change is one UI event, 20000 of them overflow the
+    -- event ring before the next flush. Meanwhile the TUI thread reads more
+    -- keys than its key buffer holds and waits for the main thread.
+    local text = ('x'):rep(10000)
+    feed_data(':for i in range(20000) | let &linespace = i % 2 | endfor\r'
+              .. 'i' .. text)
+    expect_child_buf_lines({text})
+    feed_data('\027\000')  -- ESC: go to Normal mode.
+    wait_for_mode('n')
+    local _, linespace = child_session:request('nvim_get_option', 'linespace')
+    eq(1, linespace)
+  end)
 end)
 
 describe('TUI', function()
@@ -1154,6 +1183,58 @@ describe('TUI FocusGained/FocusLost', function()
   end)
 end)
 
+describe('TUI output', function()
+  local outfile = 'Xtui_output'
+  local child_session
+
+  after_each(function()
+    os.remove(outfile)
+  end)
+
+  -- Starts a TUI with the environment `env`, its output goes through a pipe
+  -- to `outfile`.
+  local function setup(env)
+    clear()
+    local child_server = helpers.new_pipename()
+    thelpers.screen_setup(0, string.format(
+      [=[['sh', '-c', '%s %s --listen %s -u NONE -i NONE --cmd "%s" | cat > %s']]=],
+      env, nvim_prog, child_server, nvim_set, outfile))
+    retry(nil, nil, function()
+      ok(#(read_file(outfile) or '') > 0)
+    end)
+    child_session = helpers.connect(child_server)
+  end
+
+  -- Runs `cmd` in the TUI child, returns the output written for it once it
+  -- matches `pattern`.
+  local function output_of(cmd, pattern)
+    local before = #(read_file(outfile) or '')
+    child_session:request('nvim_command', cmd)
+    local out
+    retry(nil, nil, function()
+      out = (read_file(outfile) or ''):sub(before + 1)
+      ok(out:find(pattern) ~= nil)
+    end)
+    return out
+  end
+
+  it('sends runs with REP to a terminal known to support it', function()
+    setup('TERM=xterm-256color XTERM_VERSION="XTerm(370)"')
+    -- The first cell is printed, REP repeats it 39 times.
+    output_of("call setline(1, repeat('x', 40)) | redraw", 'x\27%[39b')
+  end)
+
+  it('does not send REP to other terminals, erases with ECH', function()
+    -- :terminal (libvterm) claims to be xterm but has no REP.
+    setup('TERM=xterm-256color XTERM_VERSION=')
+    local out = output_of("call setline(1, repeat('x', 30)) | redraw", ('x'):rep(30))
+    eq(nil, out:find('\27%[%d+b'))
+    -- Clearing the end of the line in the left window doesn't reach the right
+    -- margin, so it can't use EL.
+    output_of("vsplit | call setline(1, 'y') | redraw", '\27%[%d+X')
+  end)
+end)
+
 -- These tests require `thelpers` because --headless/--embed
 -- does not initialize the TUI.
 describe("TUI 't_Co' (terminal colors)", function()
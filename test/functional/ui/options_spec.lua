@@ -31,6 +31,7 @@ describe('UI receives option updates', function()
       ext_multigrid=false,
       ext_messages=false,
       ext_termcolors=false,
+      ext_grid_binary=false,
     }
 
     clear(...)
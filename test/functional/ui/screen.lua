@@ -924,6 +924,51 @@ function Screen:_handle_grid_line(grid, row, col, items)
   end
 end
 
+function Screen:_handle_grid_line_binary(grid, row, col, glyphs, data)
+  assert(self._options.ext_grid_binary)
+  local pos = 1
+  local function varint()
+    local n, shift = 0, 0
+    while true do
+      local byte = data:byte(pos)
+      pos = pos+1
+      n = n + (byte % 128) * 2^shift
+      if byte < 128 then
+        return n
+      end
+      shift = shift+7
+    end
+  end
+
+  local line = self._grids[grid].rows[row+1]
+  local ncells = varint()
+  local texts = {}
+  while #texts < ncells do
+    local code = varint()
+    if code == 0 then
+      for _ = 1, varint() do
+        table.insert(texts, texts[#texts])
+      end
+    elseif code < 128 then
+      table.insert(texts, string.char(code))
+    else
+      table.insert(texts, glyphs[code-127])
+    end
+  end
+  local colpos = col+1
+  for i = 1, ncells do
+    line[colpos+i-1].text = texts[i]
+  end
+  while colpos < col+1+ncells do
+    local hl_id, count = varint(), varint()
+    for _ = 1, count do
+      line[colpos].hl_id = hl_id
+      colpos = colpos+1
+    end
+  end
+  assert(pos == #data+1)
+end
+
 function Screen:_handle_bell()
   self.bell = true
 end
@@ -45,13 +45,13 @@ describe('screen', function()
   end)
 end)
 
-local function screen_tests(linegrid)
+local function screen_tests(linegrid, binary)
   local screen
 
   before_each(function()
     clear()
     screen = Screen.new()
-    screen:attach({rgb=true,ext_linegrid=linegrid})
+    screen:attach({rgb=true,ext_linegrid=linegrid,ext_grid_binary=binary})
     screen:set_default_attr_ids( {
       [0] = {bold=true, foreground=255},
       [1] = {bold=true, reverse=true},
@@ -1008,6 +1008,29 @@ describe("Screen (line-based)", function()
   screen_tests(true)
 end)
 
+describe("Screen (binary line-based)", function()
+  screen_tests(true, true)
+
+  it('packs multibyte and double-width text', function()
+    clear()
+    local screen = Screen.new(20, 4)
+    screen:attach({rgb=true,ext_grid_binary=true})
+    screen:set_default_attr_ids({
+      [1] = {bold=true, foreground=Screen.colors.Blue},
+      [2] = {foreground=Screen.colors.Red},
+    })
+    command('highlight Red guifg=Red')
+    command("call matchadd('Red', '口口')")
+    insert('äää 口口 aaaaaaaa')
+    screen:expect([[
+      äää {2:口口} aaaaaaa^a   |
+      {1:~                   }|
+      {1:~                   }|
+                          |
+    ]])
+  end)
+end)
+
 describe('Screen default colors', function()
   local screen
   local function startup(light, termcolors)
@@ -5,6 +5,7 @@ local nvim_dir = helpers.nvim_dir
 local eq, call, clear, eval, feed_command, feed, nvim =
   helpers.eq, helpers.call, helpers.clear, helpers.eval, helpers.feed_command,
   helpers.feed, helpers.nvim
+local ok = helpers.ok
 local command = helpers.command
 local exc_exec = helpers.exc_exec
 local iswin = helpers.iswin
@@ -565,6 +566,51 @@ describe('systemlist()', function()
     end)
   end)
 
+  describe('with on_lines', function()
+    before_each(function()
+      helpers.source([[
+        function! OnLines(lines)
+          call add(g:calls, a:lines)
+        endfunction
+      ]])
+    end)
+
+    local function lines(input, keepempty)
+      nvim('set_var', 'calls', {})
+      nvim('set_var', 'input', input)
+      eq({}, eval(string.format("systemlist('cat', g:input, %d, {'on_lines': 'OnLines'})",
+                                keepempty)))
+      local rv = {}
+      for _, call_lines in ipairs(eval('g:calls')) do
+        for _, line in ipairs(call_lines) do
+          table.insert(rv, line)
+        end
+      end
+      return rv
+    end
+
+    it('passes the lines to the callback', function()
+      eq({'aa', 'b\nb', '', 'cc'}, lines({'aa', 'b\nb', '', 'cc'}, 0))
+      eq({'aa', 'bb'}, lines({'aa', 'bb', ''}, 0))
+      eq({'aa', 'bb', ''}, lines({'aa', 'bb', ''}, 1))
+      eq({}, lines({}, 1))
+    end)
+
+    it('passes a lot of output in several calls', function()
+      local input = {}
+      for i = 1, 0xffff do
+        input[i] = tostring(i)
+      end
+      eq(input, lines(input, 0))
+      ok(eval('len(g:calls)') > 1)
+    end)
+
+    it('fails with invalid options', function()
+      eq('Vim(call):E715: Dictionary required',
+         pcall_err(command, "call systemlist('cat', '', 0, 1)"))
+    end)
+  end)
+
   it("with a program that doesn't close stdout will exit properly after passing input", function()
     local out = eval(string.format("systemlist('%s', 'clip-data')", nvim_dir..'/streams-test'))
     assert(out[1]:sub(0, 5) == 'pid: ', out)
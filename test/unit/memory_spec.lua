@@ -50,3 +50,39 @@ describe('xstrlcat()', function()
   end)
 
 end)
+
+describe('arena', function()
+  itp('allocates aligned memory from shared blocks', function()
+    local arena = ffi.new('Arena[1]')
+    local str = cimp.arena_memdupz(arena, 'abc', 3)
+    eq('abc', ffi.string(str))
+    local p = ffi.cast('char *', cimp.arena_alloc(arena, 16, true))
+    eq(0, tonumber(ffi.cast('uintptr_t', p)) % ffi.sizeof('double'))
+    -- Both come from the same block.
+    eq(8, p - str)
+    local mem = cimp.arena_finish(arena)
+    eq(true, mem.prev == nil)
+    eq(true, arena[0].cur_blk == nil)
+    cimp.arena_mem_free(mem)
+  end)
+
+  itp('gives big allocations a block of their own', function()
+    local arena = ffi.new('Arena[1]')
+    cimp.arena_alloc(arena, 8, true)
+    local blk = arena[0].cur_blk
+    local big = ffi.cast('char *', cimp.arena_alloc(arena, 10000, false))
+    ffi.fill(big, 10000, 65)
+    -- The current block is kept for small allocations.
+    eq(blk, arena[0].cur_blk)
+    local mem = cimp.arena_finish(arena)
+    eq(10000 + ffi.sizeof('struct consumed_blk'), tonumber(mem.prev.size))
+    eq(true, mem.prev.prev == nil)
+    cimp.arena_mem_free(mem)
+  end)
+
+  itp('falls back to xmalloc() without an arena', function()
+    local p = cimp.arena_memdupz(nil, 'abc', 3)
+    eq('abc', ffi.string(p))
+    cimp.xfree(p)
+  end)
+end)
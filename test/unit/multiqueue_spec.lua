@@ -146,4 +146,87 @@ describe("multiqueue (multi-level event-queue)", function()
     eq('c3i1', get(child3))
     eq('c3i2', get(child3))
   end)
+
+  itp('skips links of events removed from the child after replacing the parent', function()
+    local parent2 = multiqueue.multiqueue_new_parent(ffi.NULL, ffi.NULL)
+    eq('c1i1', get(child1))
+    eq('c1i2', get(child1))
+    eq('c1i3', get(child1))
+    multiqueue.multiqueue_replace_parent(child1, parent2)
+    put(child1, 'c1i4')
+    eq('c2i1', get(parent))
+    eq(5, multiqueue.multiqueue_size(parent))
+    eq('c1i4', get(parent2))
+    free(child1)
+    free(parent2)
+  end)
+
+  itp('drops the links of many events taken from a child queue', function()
+    -- Like a nested loop that only processes the events of child1.
+    eq('c1i1', get(child1))
+    eq('c1i2', get(child1))
+    eq('c1i3', get(child1))
+    for i = 1, 1000 do
+      -- `str` is alive until it is taken again.
+      local str = 'x' .. i
+      put(child1, str)
+      eq(str, get(child1))
+    end
+    put(child1, 'c1i4')
+    eq(7, multiqueue.multiqueue_size(parent))
+    for _, expected in ipairs({'c2i1', 'c2i2', 'c2i3', 'c2i4', 'c3i1', 'c3i2', 'c1i4'}) do
+      eq(expected, get(parent))
+    end
+    eq(0, multiqueue.multiqueue_size(parent))
+  end)
+
+  itp('processes high priority events first', function()
+    local high = multiqueue.multiqueue_new_child(parent)
+    multiqueue.multiqueue_set_priority(high, multiqueue.kMultiQueuePriorityHigh)
+    put(high, 'h1')
+    put(high, 'h2')
+    eq(11, multiqueue.multiqueue_size(parent))
+    eq('h1', get(parent))
+    eq('c1i1', get(child1))
+    eq('h2', get(parent))
+    eq('c1i2', get(parent))
+  end)
+
+  itp('does not starve normal priority events', function()
+    local high = multiqueue.multiqueue_new_child(parent)
+    multiqueue.multiqueue_set_priority(high, multiqueue.kMultiQueuePriorityHigh)
+    for i = 1, 10 do
+      put(high, 'h' .. i)
+    end
+    for i = 1, 8 do
+      eq('h' .. i, get(parent))
+    end
+    eq('c1i1', get(parent))
+    eq('h9', get(parent))
+    eq('h10', get(parent))
+    eq('c1i2', get(parent))
+  end)
+
+  itp('keeps the order of events put and taken in turns', function()
+    local children = {child1, child2, child3}
+    local expected = {'c1i1', 'c1i2', 'c2i1', 'c1i3', 'c2i2', 'c2i3', 'c2i4', 'c3i1', 'c3i2'}
+    local got = {}
+    for i = 1, 300 do
+      -- `expected` keeps the string alive while the queue points to it.
+      local str = 'x' .. i
+      table.insert(expected, str)
+      put(children[i % 3 + 1], str)
+      if i % 10 == 0 then
+        for _ = 1, 10 do
+          table.insert(got, get(parent))
+        end
+      end
+    end
+    eq(9, multiqueue.multiqueue_size(parent))
+    for _ = 1, 9 do
+      table.insert(got, get(parent))
+    end
+    eq(expected, got)
+    eq(0, multiqueue.multiqueue_size(parent))
+  end)
 end)
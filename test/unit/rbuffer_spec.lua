@@ -7,7 +7,7 @@ local cstr = helpers.cstr
 local to_cstr = helpers.to_cstr
 local child_call_once = helpers.child_call_once
 
-local rbuffer = helpers.cimport("./test/unit/fixtures/rbuffer.h")
+local rbuffer = helpers.cimport("./test/unit/fixtures/rbuffer.h", "./src/nvim/memory.h")
 
 describe('rbuffer functions', function()
   local capacity = 16
@@ -301,6 +301,48 @@ describe('rbuffer functions', function()
     end)
   end)
 
+  describe('rbuffer_resize', function()
+    itp('keeps the data, moved to the beginning', function()
+      write('1234567890')
+      read(4)
+      write('abcdefghij')
+      rbuffer.rbuffer_resize(rbuf, 32)
+      eq(32, rbuffer.rbuffer_capacity(rbuf))
+      eq(16, rbuffer.rbuffer_size(rbuf))
+      eq('567890abcdefghij', ffi.string(rbuf.start_ptr, 16))
+      eq(3, write('xyz'))
+      eq('567890abcdefghijxyz', read(40))
+    end)
+
+    itp('shrinks to the size of the data', function()
+      write('12345678')
+      read(4)
+      rbuffer.rbuffer_resize(rbuf, 4)
+      eq(0, rbuffer.rbuffer_space(rbuf))
+      eq('5678', read(8))
+    end)
+  end)
+
+  describe('rbuffer_take', function()
+    itp('takes the memory and keeps the rest of the data', function()
+      write('1234567890')
+      local data = rbuffer.rbuffer_take(rbuf, 4)
+      eq('1234', ffi.string(data, 4))
+      rbuffer.xfree(data)
+      eq(capacity, rbuffer.rbuffer_capacity(rbuf))
+      eq('567890', read(20))
+      eq(16, write('very very long string'))
+      eq('very very long s', read(20))
+    end)
+
+    itp('returns NULL if the data is not at the beginning', function()
+      write('1234567890')
+      read(2)
+      eq(true, rbuffer.rbuffer_take(rbuf, 4) == nil)
+      eq('34567890', read(20))
+    end)
+  end)
+
   describe('wrapping behavior', function()
     itp('writing/reading wraps across the end of the internal buffer', function()
       write('1234567890')